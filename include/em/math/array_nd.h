@@ -0,0 +1,350 @@
+#pragma once
+
+#include "em/macros/portable/tiny_func.h"
+#include "em/math/min_max.h"
+#include "em/math/namespaces.h"
+#include "em/math/vector.h"
+#include "em/meta/common.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Dense 2D/3D/4D arrays indexed by integer vectors, with a choice of memory layout.
+//
+// The layout is a class with a nested `template <int N> class mapping`, which must have:
+//   * A constructor from `vec<int, N>` (the array size).
+//   * `std::size_t storage_size() const` - how many elements to allocate.
+//   * `std::size_t index(vec<int, N> pos) const` - maps a position to an element index.
+//   * `void for_each_in_region(vec<int, N> begin, vec<int, N> end, auto &&func) const` - calls `func(pos, index)` for all positions in `[begin, end)`,
+//       in whatever order is the most cache-friendly for this layout.
+
+namespace em::Math
+{
+    namespace detail::ArrayNd
+    {
+        // Calls `func(pos)` for every row along X in `[begin, end)`, with `pos.x == begin.x`. The other components change in row-major order.
+        // This expands to `N - 1` nested loops.
+        template <int D = -1, int N>
+        EM_TINY constexpr void ForEachRow(vec<int, N> &pos, const vec<int, N> &begin, const vec<int, N> &end, auto &&func)
+        {
+            if constexpr (D == -1)
+            {
+                pos = begin;
+                ForEachRow<N - 1>(pos, begin, end, func);
+            }
+            else if constexpr (D == 0)
+            {
+                func(std::as_const(pos));
+            }
+            else
+            {
+                for (pos[D] = begin[D]; pos[D] < end[D]; pos[D]++)
+                    ForEachRow<D - 1>(pos, begin, end, func);
+            }
+        }
+
+        // Same, but for every element, with `N` nested loops.
+        template <int N>
+        EM_TINY constexpr void ForEachElem(const vec<int, N> &begin, const vec<int, N> &end, auto &&func)
+        {
+            vec<int, N> pos;
+            ForEachRow(pos, begin, end, [&](const vec<int, N> &row)
+            {
+                vec<int, N> p = row;
+                for (; p.x < end.x; p.x++)
+                    func(std::as_const(p));
+            });
+        }
+
+        // Returns true if `begin <= end` elementwise.
+        template <int N>
+        [[nodiscard]] constexpr bool IsValidRange(const vec<int, N> &begin, const vec<int, N> &end)
+        {
+            for (int i = 0; i < N; i++)
+            {
+                if (begin[i] > end[i])
+                    return false;
+            }
+            return true;
+        }
+    }
+
+    // Row-major layout, X changes the fastest.
+    struct layout_row_major
+    {
+        template <int N>
+        class mapping
+        {
+            vec<int, N> size;
+
+          public:
+            constexpr mapping() {}
+            constexpr explicit mapping(const vec<int, N> &size) : size(size) {}
+
+            [[nodiscard]] constexpr std::size_t storage_size() const
+            {
+                return size.template to<std::size_t>().prod();
+            }
+
+            [[nodiscard]] EM_TINY constexpr std::size_t index(const vec<int, N> &pos) const
+            {
+                std::size_t ret = std::size_t(pos[N - 1]);
+                for (int i = N - 2; i >= 0; i--)
+                    ret = ret * std::size_t(size[i]) + std::size_t(pos[i]);
+                return ret;
+            }
+
+            constexpr void for_each_in_region(const vec<int, N> &begin, const vec<int, N> &end, auto &&func) const
+            {
+                vec<int, N> pos;
+                detail::ArrayNd::ForEachRow(pos, begin, end, [&](const vec<int, N> &row)
+                {
+                    // The innermost loop has a contiguous index.
+                    const std::size_t base = index(row) - std::size_t(begin.x);
+                    vec<int, N> p = row;
+                    for (; p.x < end.x; p.x++)
+                        func(std::as_const(p), base + std::size_t(p.x));
+                });
+            }
+        };
+    };
+
+    // Tiled layout: the array is split into `TileSize^N` tiles (the size is padded to whole tiles).
+    // Each tile is contiguous and row-major inside, and the tiles are arranged in row-major order.
+    // This makes neighborhood accesses (e.g. stencils) more cache-friendly, especially in 3D, where the row-major neighbors along Z are far apart.
+    // `TileSize` must be a power of two, so indexing doesn't need divisions.
+    template <int TileSize>
+    requires (TileSize > 0 && std::has_single_bit(unsigned(TileSize)))
+    struct layout_tiled
+    {
+        template <int N>
+        class mapping
+        {
+            static constexpr int shift = std::countr_zero(unsigned(TileSize));
+            static constexpr int mask = TileSize - 1;
+            static constexpr std::size_t tile_volume = std::size_t(1) << (shift * N);
+
+            vec<int, N> num_tiles;
+
+            [[nodiscard]] EM_TINY constexpr std::size_t TileIndex(const vec<int, N> &tile) const
+            {
+                std::size_t ret = std::size_t(tile[N - 1]);
+                for (int i = N - 2; i >= 0; i--)
+                    ret = ret * std::size_t(num_tiles[i]) + std::size_t(tile[i]);
+                return ret * tile_volume;
+            }
+
+            [[nodiscard]] EM_TINY static constexpr std::size_t LocalIndex(const vec<int, N> &local)
+            {
+                std::size_t ret = std::size_t(local[N - 1]);
+                for (int i = N - 2; i >= 0; i--)
+                    ret = ret << shift | std::size_t(local[i]);
+                return ret;
+            }
+
+          public:
+            constexpr mapping() {}
+            constexpr explicit mapping(const vec<int, N> &size) : num_tiles((size + mask) >> shift) {}
+
+            [[nodiscard]] constexpr std::size_t storage_size() const
+            {
+                return num_tiles.template to<std::size_t>().prod() * tile_volume;
+            }
+
+            [[nodiscard]] EM_TINY constexpr std::size_t index(const vec<int, N> &pos) const
+            {
+                return TileIndex(pos >> shift) + LocalIndex(pos & mask);
+            }
+
+            // Visits the region tile by tile.
+            constexpr void for_each_in_region(const vec<int, N> &begin, const vec<int, N> &end, auto &&func) const
+            {
+                // Stop early if the region is empty, because `end - 1` below would be wrong.
+                for (int i = 0; i < N; i++)
+                {
+                    if (begin[i] >= end[i])
+                        return;
+                }
+
+                detail::ArrayNd::ForEachElem<N>(begin >> shift, ((end - 1) >> shift) + 1, [&](const vec<int, N> &tile)
+                {
+                    // The part of the region in this tile.
+                    const vec<int, N> tile_begin = max(begin, tile << shift);
+                    const vec<int, N> tile_end = min(end, (tile + 1) << shift);
+                    const std::size_t tile_base = TileIndex(tile);
+
+                    vec<int, N> pos;
+                    detail::ArrayNd::ForEachRow(pos, tile_begin, tile_end, [&](const vec<int, N> &row)
+                    {
+                        // The innermost loop has a contiguous index.
+                        const std::size_t base = tile_base + LocalIndex(row & mask) - std::size_t(row.x & mask);
+                        vec<int, N> p = row;
+                        for (; p.x < tile_end.x; p.x++)
+                            func(std::as_const(p), base + std::size_t(p.x & mask));
+                    });
+                });
+            }
+        };
+    };
+
+
+    // A non-owning view of a rectangular region of an `array_nd`. `T` can be const.
+    template <typename T, int N, typename Layout = layout_row_major>
+    class array_view
+    {
+      public:
+        using value_type = std::remove_const_t<T>;
+        using layout_type = Layout;
+        using coord_type = vec<int, N>;
+
+      private:
+        using mapping_type = typename Layout::template mapping<N>;
+
+        T *storage = nullptr;
+        mapping_type mapping;
+        coord_type offset;
+        coord_type view_size;
+
+        template <typename, int, typename> friend class array_view;
+
+      public:
+        constexpr array_view() {}
+
+        // Normally you don't need to call this directly, use `array_nd::view()` and `array_nd::region()` instead.
+        constexpr array_view(T *storage, const mapping_type &mapping, const coord_type &offset, const coord_type &size)
+            : storage(storage), mapping(mapping), offset(offset), view_size(size)
+        {}
+
+        // Views of non-const elements convert to views of const ones.
+        template <typename U> requires std::is_same_v<const U, T> && (!std::is_same_v<U, T>)
+        constexpr array_view(const array_view<U, N, Layout> &other)
+            : storage(other.storage), mapping(other.mapping), offset(other.offset), view_size(other.view_size)
+        {}
+
+        [[nodiscard]] constexpr const coord_type &size() const {return view_size;}
+
+        // Returns true if the position is in bounds.
+        [[nodiscard]] constexpr bool bounds_contain(const coord_type &pos) const
+        {
+            return detail::ArrayNd::IsValidRange(coord_type{}, pos) && detail::ArrayNd::IsValidRange(pos + 1, view_size);
+        }
+
+        // Returns an element, without bounds checking.
+        [[nodiscard]] EM_TINY constexpr T &operator[](const coord_type &pos) const
+        {
+            return storage[mapping.index(offset + pos)];
+        }
+
+        // Returns an element, throws if out of bounds.
+        [[nodiscard]] constexpr T &at(const coord_type &pos) const
+        {
+            if (!bounds_contain(pos))
+                throw std::out_of_range("Array index is out of range.");
+            return (*this)[pos];
+        }
+
+        // Returns a smaller view, at `begin` relative to this one. Throws if out of bounds.
+        [[nodiscard]] constexpr array_view region(const coord_type &begin, const coord_type &size) const
+        {
+            if (!detail::ArrayNd::IsValidRange(coord_type{}, begin) || !detail::ArrayNd::IsValidRange(coord_type{}, size) || !detail::ArrayNd::IsValidRange(begin + size, view_size))
+                throw std::out_of_range("Array region is out of range.");
+            return array_view(storage, mapping, offset + begin, size);
+        }
+
+        // Calls `func(pos, elem)` for every element, where `pos` is relative to this view.
+        // The order is unspecified, it's whatever is the most cache-friendly for the layout. For row-major layouts this compiles to `N` nested loops.
+        constexpr void for_each(auto &&func) const
+        {
+            mapping.for_each_in_region(offset, offset + view_size, [&](const coord_type &pos, std::size_t index)
+            {
+                func(pos - offset, storage[index]);
+            });
+        }
+    };
+
+
+    // A dense array indexed by `vec<int, N>`.
+    // `T` can't be `bool`, since the elements are returned by reference and `std::vector<bool>` can't do that. Use `std::uint8_t` instead.
+    template <Meta::cvref_unqualified T, int N, typename Layout = layout_row_major> requires (!std::is_same_v<T, bool>) && detail::Vector::ValidSize<N>
+    class array_nd
+    {
+      public:
+        using value_type = T;
+        using layout_type = Layout;
+        using coord_type = vec<int, N>;
+
+      private:
+        using mapping_type = typename Layout::template mapping<N>;
+
+        coord_type array_size;
+        mapping_type mapping;
+        std::vector<T> storage;
+
+      public:
+        constexpr array_nd() {}
+
+        // Creates an array filled with `value`. Throws if the size is negative.
+        constexpr explicit array_nd(const coord_type &size, const T &value = T{})
+            : array_size(size), mapping(size)
+        {
+            if (!detail::ArrayNd::IsValidRange(coord_type{}, size))
+                throw std::length_error("Array size can't be negative.");
+            storage.assign(mapping.storage_size(), value);
+        }
+
+        [[nodiscard]] constexpr const coord_type &size() const {return array_size;}
+
+        // The underlying storage, in the layout order. For non-row-major layouts this can include padding.
+        [[nodiscard]] constexpr T *data() {return storage.data();}
+        [[nodiscard]] constexpr const T *data() const {return storage.data();}
+        [[nodiscard]] constexpr std::size_t storage_size() const {return storage.size();}
+
+        // Returns true if the position is in bounds.
+        [[nodiscard]] constexpr bool bounds_contain(const coord_type &pos) const {return view().bounds_contain(pos);}
+
+        // Returns an element, without bounds checking.
+        [[nodiscard]] EM_TINY constexpr T &operator[](const coord_type &pos) {return storage[mapping.index(pos)];}
+        [[nodiscard]] EM_TINY constexpr const T &operator[](const coord_type &pos) const {return storage[mapping.index(pos)];}
+
+        // Returns an element, throws if out of bounds.
+        [[nodiscard]] constexpr T &at(const coord_type &pos) {return view().at(pos);}
+        [[nodiscard]] constexpr const T &at(const coord_type &pos) const {return view().at(pos);}
+
+        // Returns a view of the entire array.
+        [[nodiscard]] constexpr array_view<T, N, Layout> view() {return {storage.data(), mapping, coord_type{}, array_size};}
+        [[nodiscard]] constexpr array_view<const T, N, Layout> view() const {return {storage.data(), mapping, coord_type{}, array_size};}
+
+        // Returns a view of a part of the array. Throws if out of bounds.
+        [[nodiscard]] constexpr array_view<T, N, Layout> region(const coord_type &begin, const coord_type &size) {return view().region(begin, size);}
+        [[nodiscard]] constexpr array_view<const T, N, Layout> region(const coord_type &begin, const coord_type &size) const {return view().region(begin, size);}
+
+        // Calls `func(pos, elem)` for every element. See `array_view::for_each()`.
+        constexpr void for_each(auto &&func) {view().for_each(func);}
+        constexpr void for_each(auto &&func) const {view().for_each(func);}
+
+        // Sets all elements to `value`.
+        constexpr void fill(const T &value)
+        {
+            std::fill(storage.begin(), storage.end(), value);
+        }
+    };
+
+    // Shorthands for the common dimensions.
+    template <typename T, typename Layout = layout_row_major> using array2d = array_nd<T, 2, Layout>;
+    template <typename T, typename Layout = layout_row_major> using array3d = array_nd<T, 3, Layout>;
+
+    inline namespace Common
+    {
+        using Math::array_nd;
+        using Math::array2d;
+        using Math::array3d;
+        using Math::array_view;
+        using Math::layout_row_major;
+        using Math::layout_tiled;
+    }
+}
@@ -0,0 +1,430 @@
+#pragma once
+
+#include "em/math/namespaces.h"
+#include "em/math/parallel.h"
+#include "em/math/ray.h"
+#include "em/math/rect.h"
+#include "em/math/scalar.h"
+#include "em/math/vector.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// A bounding volume hierarchy over axis-aligned boxes, for ray casts and overlap queries in dynamic scenes.
+
+namespace em::Math
+{
+    namespace detail::Bvh
+    {
+        // Half of the surface area (half of the perimeter in 2D), for the surface area heuristic.
+        template <typename T, int N>
+        [[nodiscard]] constexpr T HalfArea(const rect<T, N> &r)
+        {
+            const vec<T, N> s = r.size();
+            if constexpr (N == 2)
+                return s.x + s.y;
+            else
+                return s.x * s.y + s.y * s.z + s.z * s.x;
+        }
+
+        // An inverted box, which becomes the other box when united with it.
+        template <typename T, int N>
+        [[nodiscard]] constexpr rect<T, N> EmptyBounds()
+        {
+            return rect<T, N>(vec<T, N>(std::numeric_limits<T>::infinity()), vec<T, N>(-std::numeric_limits<T>::infinity()));
+        }
+
+        // Like `rect::overlaps()`, but the touching boxes count too, so the boxes of zero size can be found.
+        template <typename T, int N>
+        [[nodiscard]] constexpr bool Touches(const rect<T, N> &x, const rect<T, N> &y)
+        {
+            bool ret = true;
+            for (int i = 0; i < N; i++)
+                ret &= (x.a[i] <= y.b[i]) & (y.a[i] <= x.b[i]);
+            return ret;
+        }
+    }
+
+    // A binary BVH, built with the binned surface area heuristic. The primitives are given as their bounding boxes, and are referred to by their indices.
+    // Rebuild it when the scene changes a lot, or `refit()` it when the primitives only move a bit (which is much faster, but the tree quality degrades over time).
+    // Holds on to its memory, so rebuilding every frame doesn't allocate.
+    //
+    // The queries only check the node boxes, and report all primitives in the leaves they reach, so test the primitives themselves if you need exact results.
+    // The number of primitives is limited to `2^32 - 1`.
+    template <floating_point_scalar T, int N = 3> requires(N == 2 || N == 3)
+    class bvh
+    {
+      public:
+        using type = T;
+        static constexpr int dims = N;
+
+        // For `fvec3` this is 32 bytes, so two of them fit in a cache line.
+        struct node
+        {
+            // The bounding box.
+            vec<T, N> a;
+            // For leaves, the first element of `indices()` belonging to this leaf. For other nodes, the left child, followed by the right child.
+            std::uint32_t first = 0;
+            vec<T, N> b;
+            // The number of primitives in a leaf, or 0 for other nodes.
+            std::uint32_t count = 0;
+
+            [[nodiscard]] constexpr bool is_leaf() const {return count > 0;}
+            [[nodiscard]] constexpr rect<T, N> bounds() const {return rect<T, N>(a, b);}
+        };
+
+        // The max number of bins per axis for the SAH. Small nodes use fewer bins.
+        static constexpr int num_bins = 16;
+        // Leaves never have more primitives than this. Bigger nodes are split even if the SAH says not to, at the median if the SAH can't split them
+        //   (e.g. when their centroids coincide).
+        static constexpr std::uint32_t max_leaf_size = 8;
+        // Inputs with less than this many primitives per thread use fewer threads.
+        static constexpr std::size_t min_elements_per_thread = 1 << 12;
+
+      private:
+        // The SAH cost of visiting a node, relative to testing one primitive.
+        static constexpr T traversal_cost = 1;
+        // Below this depth the nodes are split at the median instead of using the SAH, to limit the depth to about `max_sah_depth + 32`.
+        static constexpr int max_sah_depth = 64;
+        // The stack size for the queries, enough for any depth we can produce.
+        static constexpr int max_stack_size = 128;
+
+        // The root is the first node, and the children always come after their parents.
+        std::vector<node> node_list;
+        // The leaves refer to ranges in this array, which has the primitive indices.
+        std::vector<std::uint32_t> prim_indices;
+        // The box centers, only used while building.
+        std::vector<vec<T, N>> centroids;
+
+        using Task = detail::Parallel::SubtreeTask;
+
+        [[nodiscard]] static constexpr int BinIndex(T centroid, T low, T scale, int bins)
+        {
+            const int ret = int((centroid - low) * scale);
+            return ret < bins - 1 ? ret : bins - 1;
+        }
+
+        // Tries to split `[begin, end)` using the binned SAH. Returns the split point, or `begin` if a leaf is cheaper or the primitives can't be binned.
+        constexpr std::size_t SahSplit(std::span<const rect<T, N>> boxes, std::size_t begin, std::size_t end, const rect<T, N> &bounds, const rect<T, N> &centroid_bounds)
+        {
+            const std::size_t count = end - begin;
+            // Sweeping all bins would dominate the build time for the small nodes near the leaves.
+            const int bins = count < std::size_t(num_bins) ? int(count) : num_bins;
+
+            // Comparing the costs multiplied by the parent area, to avoid dividing by it.
+            const T parent_area = detail::Bvh::HalfArea(bounds);
+            T best_cost = count > max_leaf_size ? std::numeric_limits<T>::infinity() : (T(count) - traversal_cost) * parent_area;
+            int best_axis = -1;
+            int best_bin = 0;
+
+            for (int axis = 0; axis < N; axis++)
+            {
+                const T extent = centroid_bounds.b[axis] - centroid_bounds.a[axis];
+                if (!(extent > 0))
+                    continue;
+                const T scale = T(bins) / extent;
+                // A tiny (subnormal) extent makes this infinite, and then `BinIndex()` would compute `0 * inf`. Treat it like a zero extent.
+                if (!(scale < std::numeric_limits<T>::infinity()))
+                    continue;
+
+                std::array<rect<T, N>, num_bins> bin_bounds;
+                std::fill_n(bin_bounds.begin(), bins, detail::Bvh::EmptyBounds<T, N>());
+                std::array<std::size_t, num_bins> bin_counts{};
+                for (std::size_t i = begin; i < end; i++)
+                {
+                    const std::uint32_t prim = prim_indices[i];
+                    const int bin = BinIndex(centroids[prim][axis], centroid_bounds.a[axis], scale, bins);
+                    bin_bounds[std::size_t(bin)] = bin_bounds[std::size_t(bin)].unite(boxes[prim]);
+                    bin_counts[std::size_t(bin)]++;
+                }
+
+                // `right_costs[i]` is for the bins `[i, bins)`.
+                std::array<T, num_bins> right_costs{};
+                rect<T, N> acc = detail::Bvh::EmptyBounds<T, N>();
+                std::size_t acc_count = 0;
+                for (int bin = bins - 1; bin > 0; bin--)
+                {
+                    acc = acc.unite(bin_bounds[std::size_t(bin)]);
+                    acc_count += bin_counts[std::size_t(bin)];
+                    right_costs[std::size_t(bin)] = acc_count > 0 ? detail::Bvh::HalfArea(acc) * T(acc_count) : 0;
+                }
+
+                acc = detail::Bvh::EmptyBounds<T, N>();
+                acc_count = 0;
+                for (int bin = 0; bin < bins - 1; bin++)
+                {
+                    acc = acc.unite(bin_bounds[std::size_t(bin)]);
+                    acc_count += bin_counts[std::size_t(bin)];
+                    if (acc_count == 0 || acc_count == count)
+                        continue;
+
+                    const T cost = detail::Bvh::HalfArea(acc) * T(acc_count) + right_costs[std::size_t(bin + 1)];
+                    if (cost < best_cost)
+                    {
+                        best_cost = cost;
+                        best_axis = axis;
+                        best_bin = bin + 1;
+                    }
+                }
+            }
+
+            if (best_axis == -1)
+                return begin;
+
+            const T low = centroid_bounds.a[best_axis];
+            const T scale = T(bins) / (centroid_bounds.b[best_axis] - low);
+            auto mid = std::partition(prim_indices.begin() + std::ptrdiff_t(begin), prim_indices.begin() + std::ptrdiff_t(end), [&](std::uint32_t prim)
+            {
+                return BinIndex(centroids[prim][best_axis], low, scale, bins) < best_bin;
+            });
+            return std::size_t(mid - prim_indices.begin());
+        }
+
+        // Builds the subtree for `[begin, end)` into `out[node_index]`, appending the children to `out`.
+        // If `tasks` isn't null, the subtrees with at most `task_size` primitives are added to it instead of being built.
+        constexpr void BuildNode(std::span<const rect<T, N>> boxes, std::vector<node> &out, std::uint32_t node_index, std::size_t begin, std::size_t end, int depth, std::size_t task_size, std::vector<Task> *tasks)
+        {
+            const std::size_t count = end - begin;
+
+            if (tasks && count <= task_size)
+            {
+                tasks->push_back({node_index, begin, end, depth});
+                return;
+            }
+
+            rect<T, N> bounds = detail::Bvh::EmptyBounds<T, N>();
+            rect<T, N> centroid_bounds = detail::Bvh::EmptyBounds<T, N>();
+            for (std::size_t i = begin; i < end; i++)
+            {
+                const std::uint32_t prim = prim_indices[i];
+                bounds = bounds.unite(boxes[prim]);
+                centroid_bounds = centroid_bounds.expand_to_contain(centroids[prim]);
+            }
+            out[node_index].a = bounds.a;
+            out[node_index].b = bounds.b;
+
+            std::size_t mid = begin;
+            if (count > 1)
+            {
+                if (depth < max_sah_depth)
+                    mid = SahSplit(boxes, begin, end, bounds, centroid_bounds);
+
+                if (mid == begin && count > max_leaf_size)
+                {
+                    // Too many primitives for a leaf, split at the median of the longest axis.
+                    int axis = 0;
+                    for (int i = 1; i < N; i++)
+                    {
+                        if (centroid_bounds.b[i] - centroid_bounds.a[i] > centroid_bounds.b[axis] - centroid_bounds.a[axis])
+                            axis = i;
+                    }
+                    mid = begin + count / 2;
+                    std::nth_element(prim_indices.begin() + std::ptrdiff_t(begin), prim_indices.begin() + std::ptrdiff_t(mid), prim_indices.begin() + std::ptrdiff_t(end), [&](std::uint32_t x, std::uint32_t y)
+                    {
+                        return centroids[x][axis] < centroids[y][axis];
+                    });
+                }
+            }
+
+            if (mid == begin)
+            {
+                out[node_index].first = std::uint32_t(begin);
+                out[node_index].count = std::uint32_t(count);
+                return;
+            }
+
+            const std::uint32_t left = std::uint32_t(out.size());
+            out.resize(out.size() + 2);
+            out[node_index].first = left;
+            out[node_index].count = 0;
+            BuildNode(boxes, out, left, begin, mid, depth + 1, task_size, tasks);
+            BuildNode(boxes, out, left + 1, mid, end, depth + 1, task_size, tasks);
+        }
+
+      public:
+        constexpr bvh() {}
+
+        // The nodes, starting from the root. Empty if there are no primitives.
+        [[nodiscard]] constexpr std::span<const node> nodes() const {return node_list;}
+        // The primitive indices, which the leaves refer to.
+        [[nodiscard]] constexpr std::span<const std::uint32_t> indices() const {return prim_indices;}
+        // The number of primitives.
+        [[nodiscard]] constexpr std::size_t size() const {return prim_indices.size();}
+        [[nodiscard]] constexpr bool empty() const {return prim_indices.empty();}
+
+        // Frees the memory.
+        constexpr void clear()
+        {
+            node_list = {};
+            prim_indices = {};
+            centroids = {};
+        }
+
+        // Builds the tree for the primitives with those bounding boxes.
+        // `num_threads == 0` means `std::thread::hardware_concurrency()`. The top levels are built on one thread, then the subtrees are built in parallel.
+        constexpr void build(std::span<const rect<T, N>> boxes, int num_threads = 0)
+        {
+            if (boxes.size() > std::numeric_limits<std::uint32_t>::max())
+                throw std::length_error("Too many primitives for the BVH.");
+
+            const std::size_t n = boxes.size();
+            node_list.clear();
+            prim_indices.resize(n);
+            centroids.resize(n);
+            if (n == 0)
+                return;
+
+            const int num_chunks = parallel_chunk_count(n, num_threads, min_elements_per_thread);
+            parallel_for_chunks(n, num_chunks, [&](int, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; i++)
+                {
+                    prim_indices[i] = std::uint32_t(i);
+                    centroids[i] = boxes[i].center();
+                }
+            });
+
+            // Several tasks per thread, because the subtrees aren't equally expensive.
+            const std::size_t task_size = num_chunks > 1 ? n / (std::size_t(num_chunks) * 4) : 0;
+            std::vector<Task> tasks;
+
+            node_list.resize(1);
+            BuildNode(boxes, node_list, 0, 0, n, 0, task_size, num_chunks > 1 ? &tasks : nullptr);
+            // The tasks work on disjoint ranges of `prim_indices`.
+            detail::Parallel::BuildSubtrees(node_list, tasks, num_chunks, [&](const Task &task, std::vector<node> &subtree)
+            {
+                BuildNode(boxes, subtree, 0, task.begin, task.end, task.depth, 0, nullptr);
+            });
+        }
+
+        // Recomputes the node boxes after the primitives have moved, keeping the tree structure.
+        // `boxes` must have the same primitives in the same order as when building.
+        constexpr void refit(std::span<const rect<T, N>> boxes)
+        {
+            if (boxes.size() != prim_indices.size())
+                throw std::length_error("The number of boxes doesn't match the BVH.");
+
+            // Since the children come after their parents, they're updated first.
+            for (std::size_t i = node_list.size(); i-- > 0;)
+            {
+                node &n = node_list[i];
+                rect<T, N> bounds;
+                if (n.is_leaf())
+                {
+                    bounds = detail::Bvh::EmptyBounds<T, N>();
+                    for (std::uint32_t j = 0; j < n.count; j++)
+                        bounds = bounds.unite(boxes[prim_indices[n.first + j]]);
+                }
+                else
+                {
+                    bounds = node_list[n.first].bounds().unite(node_list[n.first + 1].bounds());
+                }
+                n.a = bounds.a;
+                n.b = bounds.b;
+            }
+        }
+
+        // Calls `func(index)` for every primitive in the leaves touching `box`. The boxes that only touch count too.
+        template <typename F>
+        constexpr void for_each_overlapping(const rect<T, N> &box, F &&func) const
+        {
+            if (node_list.empty())
+                return;
+
+            std::array<std::uint32_t, max_stack_size> stack;
+            int stack_size = 0;
+            stack[std::size_t(stack_size++)] = 0;
+
+            while (stack_size > 0)
+            {
+                const node &n = node_list[stack[std::size_t(--stack_size)]];
+                if (!detail::Bvh::Touches(n.bounds(), box))
+                    continue;
+
+                if (n.is_leaf())
+                {
+                    for (std::uint32_t j = 0; j < n.count; j++)
+                        func(prim_indices[n.first + j]);
+                }
+                else
+                {
+                    stack[std::size_t(stack_size++)] = n.first + 1;
+                    stack[std::size_t(stack_size++)] = n.first;
+                }
+            }
+        }
+
+        // Calls `func(index, t_max)` for every primitive in the leaves the ray hits, nearer leaves first.
+        // `func` should test the primitive, and if it's hit closer than `t_max`, set `t_max` to the distance, which makes the search skip the farther nodes.
+        // `t_max` starts as `query.t_max`.
+        template <typename F>
+        constexpr void for_each_ray_hit(ray_box_query<T, N> query, F &&func) const
+        {
+            if (node_list.empty())
+                return;
+
+            // The nodes to visit, and the distances at which the ray enters them.
+            std::array<std::uint32_t, max_stack_size> stack;
+            std::array<T, max_stack_size> stack_dist;
+            int stack_size = 0;
+
+            const T root_dist = intersect_ray_box(query, node_list[0].bounds());
+            if (root_dist == std::numeric_limits<T>::infinity())
+                return;
+            stack[0] = 0;
+            stack_dist[0] = root_dist;
+            stack_size = 1;
+
+            while (stack_size > 0)
+            {
+                stack_size--;
+                // Skip the nodes that are farther than the hits we already have.
+                if (stack_dist[std::size_t(stack_size)] > query.t_max)
+                    continue;
+                const node &n = node_list[stack[std::size_t(stack_size)]];
+
+                if (n.is_leaf())
+                {
+                    for (std::uint32_t j = 0; j < n.count; j++)
+                        func(prim_indices[n.first + j], query.t_max);
+                    continue;
+                }
+
+                std::uint32_t near = n.first, far = n.first + 1;
+                T near_dist = intersect_ray_box(query, node_list[near].bounds());
+                T far_dist = intersect_ray_box(query, node_list[far].bounds());
+                if (far_dist < near_dist)
+                {
+                    std::swap(near, far);
+                    std::swap(near_dist, far_dist);
+                }
+
+                // Pushing the far child first, so the near one is visited first.
+                if (far_dist != std::numeric_limits<T>::infinity())
+                {
+                    stack[std::size_t(stack_size)] = far;
+                    stack_dist[std::size_t(stack_size)] = far_dist;
+                    stack_size++;
+                }
+                if (near_dist != std::numeric_limits<T>::infinity())
+                {
+                    stack[std::size_t(stack_size)] = near;
+                    stack_dist[std::size_t(stack_size)] = near_dist;
+                    stack_size++;
+                }
+            }
+        }
+    };
+
+    inline namespace Common
+    {
+        using Math::bvh;
+    }
+}
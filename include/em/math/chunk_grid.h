@@ -0,0 +1,298 @@
+#pragma once
+
+#include "em/macros/portable/tiny_func.h"
+#include "em/math/functions.h"
+#include "em/math/namespaces.h"
+#include "em/math/vector.h"
+#include "em/meta/common.h"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace em::Math
+{
+    // A sparse infinite grid of `T`s, split into dense cubic chunks of `ChunkSize^N` cells. Missing chunks are allocated on write.
+    //
+    // The chunks are found through an open-addressing hash table (linear probing) keyed by the chunk coordinates.
+    // The last accessed chunk is cached, so spatially coherent access mostly skips the table.
+    // For power-of-two `ChunkSize`s, splitting the world coordinates uses shifts and masks instead of division.
+    //
+    // The chunks are stored in a dense list, iterating over them (or over all cells chunk by chunk) doesn't touch the hash table.
+    // Adding or removing chunks never invalidates the pointers to the cells (except for the cells of the removed chunk),
+    //   but it can invalidate the pointers to the `chunk` objects themselves.
+    //
+    // NOTE: Because of the cache, even the const functions modify the grid, so it's not safe to read it from several threads at once.
+    // `T` can't be `bool`, since the cells are returned by reference and `std::vector<bool>` can't do that. Use `std::uint8_t` instead.
+    template <Meta::cvref_unqualified T, int ChunkSize, int N = 3> requires (!std::is_same_v<T, bool>) && (ChunkSize > 0) && (N >= 2 && N <= 4)
+    class chunk_grid
+    {
+      public:
+        using value_type = T;
+        using coord_type = vec<int, N>;
+
+        static constexpr int dims = N;
+        static constexpr int chunk_size = ChunkSize;
+        // The number of cells in a chunk.
+        static constexpr int chunk_volume = ipow(ChunkSize, N);
+
+        // A chunk, as returned by the iteration functions.
+        struct chunk
+        {
+            // The chunk coordinates. Multiply by `ChunkSize` to get the world coordinates of the first cell.
+            coord_type coord;
+            // The cells, with X changing the fastest. Use `local_index()` to index this.
+            std::vector<T> cells;
+        };
+
+      private:
+        static constexpr bool is_pow2 = std::has_single_bit(unsigned(ChunkSize));
+        static constexpr int shift = std::countr_zero(unsigned(ChunkSize));
+
+        // A hash table slot.
+        struct Slot
+        {
+            coord_type coord;
+            // Index into `chunks`, or -1 if the slot is empty.
+            int index = -1;
+        };
+
+        std::vector<chunk> chunks;
+        // The size is zero or a power of two.
+        std::vector<Slot> slots;
+
+        // The cache for the last accessed chunk. `cached_index == -1` if the cache is empty.
+        mutable coord_type cached_coord;
+        mutable int cached_index = -1;
+
+        [[nodiscard]] EM_TINY constexpr std::size_t HomeSlot(const coord_type &coord) const
+        {
+            return std::hash<coord_type>{}(coord) & (slots.size() - 1);
+        }
+
+        // Returns the slot with this chunk, or -1 if not found.
+        [[nodiscard]] constexpr std::ptrdiff_t FindSlot(const coord_type &coord) const
+        {
+            if (slots.empty())
+                return -1;
+            for (std::size_t i = HomeSlot(coord);; i = (i + 1) & (slots.size() - 1))
+            {
+                if (slots[i].index == -1)
+                    return -1;
+                if (slots[i].coord == coord)
+                    return std::ptrdiff_t(i);
+            }
+        }
+
+        // Inserts a chunk into the table, which must not already have it and must have a free slot.
+        constexpr void InsertSlot(const coord_type &coord, int index)
+        {
+            std::size_t i = HomeSlot(coord);
+            while (slots[i].index != -1)
+                i = (i + 1) & (slots.size() - 1);
+            slots[i] = {coord, index};
+        }
+
+        // Rebuilds the table with a new size.
+        constexpr void Rehash(std::size_t new_num_slots)
+        {
+            slots.assign(new_num_slots, Slot{});
+            for (std::size_t i = 0; i < chunks.size(); i++)
+                InsertSlot(chunks[i].coord, int(i));
+        }
+
+        // Returns the chunk index, or -1 if there's no such chunk.
+        [[nodiscard]] constexpr int FindChunkIndex(const coord_type &coord) const
+        {
+            if (cached_index != -1 && cached_coord == coord)
+                return cached_index;
+            std::ptrdiff_t slot = FindSlot(coord);
+            if (slot == -1)
+                return -1;
+            cached_coord = coord;
+            cached_index = slots[std::size_t(slot)].index;
+            return cached_index;
+        }
+
+      public:
+        constexpr chunk_grid() {}
+
+        // Splits the world coordinates into the chunk coordinates and the coordinates inside of the chunk.
+        [[nodiscard]] static constexpr coord_type chunk_coord(const coord_type &world)
+        {
+            if constexpr (is_pow2)
+                return world >> shift; // Right shift rounds towards minus infinity, which is what we want.
+            else
+                return div_ex(world, ChunkSize);
+        }
+        [[nodiscard]] static constexpr coord_type local_coord(const coord_type &world)
+        {
+            if constexpr (is_pow2)
+                return world & (ChunkSize - 1);
+            else
+                return mod_ex(world, ChunkSize);
+        }
+        // Converts the coordinates inside of a chunk to an index in `chunk::cells`.
+        [[nodiscard]] static constexpr int local_index(const coord_type &local)
+        {
+            int ret = local[N - 1];
+            for (int i = N - 2; i >= 0; i--)
+                ret = ret * ChunkSize + local[i];
+            return ret;
+        }
+
+
+        // The number of allocated chunks.
+        [[nodiscard]] constexpr std::size_t num_chunks() const {return chunks.size();}
+
+        // Removes all chunks.
+        constexpr void clear()
+        {
+            chunks.clear();
+            slots.clear();
+            cached_index = -1;
+        }
+
+        // Preallocates the memory for the bookkeeping of this many chunks (not for the chunks themselves).
+        constexpr void reserve(std::size_t new_num_chunks)
+        {
+            chunks.reserve(new_num_chunks);
+            if (slots.size() < new_num_chunks * 2)
+                Rehash(std::bit_ceil(new_num_chunks * 2));
+        }
+
+
+        // Returns a chunk by its chunk coordinates, or null if it's not allocated.
+        [[nodiscard]] constexpr chunk *find_chunk(const coord_type &coord)
+        {
+            int index = FindChunkIndex(coord);
+            return index == -1 ? nullptr : &chunks[std::size_t(index)];
+        }
+        [[nodiscard]] constexpr const chunk *find_chunk(const coord_type &coord) const
+        {
+            return const_cast<chunk_grid &>(*this).find_chunk(coord);
+        }
+
+        // Returns a chunk by its chunk coordinates, allocating it if necessary. The new chunks are filled with `T{}`.
+        [[nodiscard]] constexpr chunk &get_or_create_chunk(const coord_type &coord)
+        {
+            if (chunk *ret = find_chunk(coord))
+                return *ret;
+
+            // Keep the load factor at most 1/2.
+            if ((chunks.size() + 1) * 2 > slots.size())
+                Rehash(slots.empty() ? 16 : slots.size() * 2);
+
+            int index = int(chunks.size());
+            chunks.push_back({coord, std::vector<T>(std::size_t(chunk_volume))});
+            InsertSlot(coord, index);
+
+            cached_coord = coord;
+            cached_index = index;
+            return chunks.back();
+        }
+
+        // Removes a chunk. Returns false if there was no such chunk.
+        // The last chunk in the iteration order is moved to the place of the removed one.
+        constexpr bool erase_chunk(const coord_type &coord)
+        {
+            std::ptrdiff_t found = FindSlot(coord);
+            if (found == -1)
+                return false;
+
+            const std::size_t mask = slots.size() - 1;
+            const int index = slots[std::size_t(found)].index;
+
+            // Backward shift deletion, which keeps the probe sequences intact without tombstones.
+            std::size_t hole = std::size_t(found);
+            for (std::size_t i = (hole + 1) & mask; slots[i].index != -1; i = (i + 1) & mask)
+            {
+                // Move the element into the hole unless its home slot is cyclically in `(hole, i]`.
+                std::size_t home = HomeSlot(slots[i].coord);
+                if (((i - home) & mask) >= ((i - hole) & mask))
+                {
+                    slots[hole] = slots[i];
+                    hole = i;
+                }
+            }
+            slots[hole] = Slot{};
+
+            // Move the last chunk into the removed one.
+            if (std::size_t(index) != chunks.size() - 1)
+            {
+                chunks[std::size_t(index)] = std::move(chunks.back());
+                slots[std::size_t(FindSlot(chunks[std::size_t(index)].coord))].index = index;
+            }
+            chunks.pop_back();
+
+            cached_index = -1;
+            return true;
+        }
+
+
+        // Returns a cell by its world coordinates, or null if its chunk isn't allocated.
+        [[nodiscard]] constexpr T *try_get(const coord_type &world)
+        {
+            chunk *c = find_chunk(chunk_coord(world));
+            return c ? &c->cells[std::size_t(local_index(local_coord(world)))] : nullptr;
+        }
+        [[nodiscard]] constexpr const T *try_get(const coord_type &world) const
+        {
+            return const_cast<chunk_grid &>(*this).try_get(world);
+        }
+
+        // Returns a cell by its world coordinates, or `fallback` if its chunk isn't allocated.
+        [[nodiscard]] constexpr T get_or(const coord_type &world, T fallback) const
+        {
+            const T *ret = try_get(world);
+            return ret ? *ret : fallback;
+        }
+
+        // Returns a cell by its world coordinates, allocating its chunk if necessary.
+        [[nodiscard]] constexpr T &operator[](const coord_type &world)
+        {
+            return get_or_create_chunk(chunk_coord(world)).cells[std::size_t(local_index(local_coord(world)))];
+        }
+
+
+        // Iteration over all allocated chunks, in an unspecified (but stable, unless chunks are added or removed) order.
+        [[nodiscard]] constexpr auto begin() {return chunks.begin();}
+        [[nodiscard]] constexpr auto end() {return chunks.end();}
+        [[nodiscard]] constexpr auto begin() const {return chunks.begin();}
+        [[nodiscard]] constexpr auto end() const {return chunks.end();}
+
+        // Calls `func(world_coord, cell)` for every cell of every allocated chunk, chunk by chunk.
+        // The cells in a chunk are visited in memory order.
+        constexpr void for_each_cell(auto &&func)
+        {
+            for (chunk &c : chunks)
+            {
+                const coord_type base = c.coord * ChunkSize;
+                coord_type local{};
+                for (T &cell : c.cells)
+                {
+                    func(base + local, cell);
+
+                    int i = 0;
+                    while (i < N - 1 && ++local[i] == ChunkSize)
+                        local[i++] = 0;
+                    if (i == N - 1)
+                        local[i]++;
+                }
+            }
+        }
+        constexpr void for_each_cell(auto &&func) const
+        {
+            const_cast<chunk_grid &>(*this).for_each_cell([&](const coord_type &world, const T &cell){func(world, cell);});
+        }
+    };
+
+    inline namespace Common
+    {
+        using Math::chunk_grid;
+    }
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "em/macros/portable/tiny_func.h"
+#include "em/math/functions.h"
+#include "em/math/larger_type.h"
+#include "em/math/vector_traits.h"
+
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+
+// Cubic curves (Bezier, Hermite, Catmull-Rom), and batched evaluation of them.
+// Everything here works both with scalars and vectors, the control points can be of any type that supports `fma()` elementwise.
+//
+// The curves are converted to the power basis once, and then evaluated with Horner's scheme (3 FMAs per element per sample).
+// This is cheaper than de Casteljau's algorithm, at the cost of being slightly less numerically stable far outside of `0 <= t <= 1`,
+//   which is a non-issue for animation curves.
+
+namespace em::Math
+{
+    // A cubic polynomial `c0 + c1 * t + c2 * t^2 + c3 * t^3`, where the coefficients are scalars or vectors.
+    template <Meta::cvref_unqualified V>
+    struct cubic_curve
+    {
+        // The type of the parameter.
+        using param_type = floating_point_t<vec_base_t<V>>;
+
+        V c0{}, c1{}, c2{}, c3{};
+
+        // From the four Bezier control points. The curve passes through `p0` at `t == 0` and `p3` at `t == 1`.
+        [[nodiscard]] static constexpr cubic_curve from_bezier(const V &p0, const V &p1, const V &p2, const V &p3)
+        {
+            return {
+                .c0 = p0,
+                .c1 = V((p1 - p0) * 3),
+                .c2 = V((p0 - p1 * 2 + p2) * 3),
+                .c3 = V(p3 - p0 + (p1 - p2) * 3),
+            };
+        }
+
+        // From two points and the derivatives at them. The curve passes through `p0` at `t == 0` and `p1` at `t == 1`.
+        [[nodiscard]] static constexpr cubic_curve from_hermite(const V &p0, const V &m0, const V &p1, const V &m1)
+        {
+            return {
+                .c0 = p0,
+                .c1 = m0,
+                .c2 = V((p1 - p0) * 3 - m0 * 2 - m1),
+                .c3 = V((p0 - p1) * 2 + m0 + m1),
+            };
+        }
+
+        // A uniform Catmull-Rom segment. The curve passes through `p1` at `t == 0` and `p2` at `t == 1`, and `p0`, `p3` only affect the tangents.
+        [[nodiscard]] static constexpr cubic_curve from_catmull_rom(const V &p0, const V &p1, const V &p2, const V &p3)
+        {
+            // Same as Hermite with `m0 = (p2 - p0) / 2` and `m1 = (p3 - p1) / 2`, with the halves factored out.
+            return {
+                .c0 = p1,
+                .c1 = V((p2 - p0) * param_type(0.5)),
+                .c2 = V((p0 * 2 - p1 * 5 + p2 * 4 - p3) * param_type(0.5)),
+                .c3 = V((p3 - p0 + (p1 - p2) * 3) * param_type(0.5)),
+            };
+        }
+
+        // Evaluates the curve at `t`.
+        [[nodiscard]] EM_TINY constexpr V operator()(param_type t) const
+        {
+            return V(fma(fma(fma(c3, t, c2), t, c1), t, c0));
+        }
+
+        // Evaluates the derivative at `t`.
+        [[nodiscard]] EM_TINY constexpr V derivative(param_type t) const
+        {
+            return V(fma(fma(c3 * param_type(3), t, c2 * param_type(2)), t, c1));
+        }
+
+        // Evaluates the curve at every `t[i]`, writing to `out[i]`. `out` must be at least as large as `t`.
+        // This is a tight loop with the coefficients hoisted out of it, so the compiler can vectorize it across samples.
+        constexpr void eval(std::span<const param_type> t, std::span<V> out) const
+        {
+            if (out.size() < t.size())
+                throw std::length_error("The output span is smaller than the input span.");
+
+            const V d0 = c0, d1 = c1, d2 = c2, d3 = c3;
+            for (std::size_t i = 0; i < t.size(); i++)
+                out[i] = V(fma(fma(fma(d3, t[i], d2), t[i], d1), t[i], d0));
+        }
+    };
+
+    namespace detail::Curves
+    {
+        // Splits the spline parameter `u` into a segment index and the local parameter, clamping to `[0, num_segments]`.
+        template <typename T>
+        [[nodiscard]] EM_TINY constexpr std::size_t SplitParam(T &u, std::size_t num_segments)
+        {
+            if (!(u > 0)) // This also catches NaN.
+            {
+                u = 0;
+                return 0;
+            }
+            if (u >= T(num_segments))
+            {
+                u = 1;
+                return num_segments - 1;
+            }
+            std::size_t i = std::size_t(u);
+            u -= T(i);
+            return i;
+        }
+
+        // Checks the sizes for the spline functions below.
+        inline constexpr void CheckSplineSizes(std::size_t num_segments, std::size_t num_params, std::size_t num_out)
+        {
+            if (num_segments == 0)
+                throw std::length_error("Not enough control points for the spline.");
+            if (num_out < num_params)
+                throw std::length_error("The output span is smaller than the input span.");
+        }
+    }
+
+    // Evaluates a piecewise cubic Bezier spline. `points` holds `3 * n + 1` control points for `n` segments (adjacent segments share an endpoint).
+    // Each `params[i]` is in range `[0, n]` (out-of-range values are clamped), the integral part selects the segment.
+    template <typename V>
+    constexpr void eval_bezier_spline(std::span<const V> points, std::span<const typename cubic_curve<V>::param_type> params, std::span<V> out)
+    {
+        const std::size_t num_segments = points.size() < 4 ? 0 : (points.size() - 1) / 3;
+        detail::Curves::CheckSplineSizes(num_segments, params.size(), out.size());
+
+        for (std::size_t i = 0; i < params.size(); i++)
+        {
+            auto u = params[i];
+            const V *p = &points[detail::Curves::SplitParam(u, num_segments) * 3];
+            out[i] = cubic_curve<V>::from_bezier(p[0], p[1], p[2], p[3])(u);
+        }
+    }
+
+    // Evaluates a piecewise cubic Hermite spline through `points`, with derivatives `tangents` at them. The two spans must have the same size.
+    // Each `params[i]` is in range `[0, points.size() - 1]` (out-of-range values are clamped), the integral part selects the segment.
+    template <typename V>
+    constexpr void eval_hermite_spline(std::span<const V> points, std::span<const V> tangents, std::span<const typename cubic_curve<V>::param_type> params, std::span<V> out)
+    {
+        if (points.size() != tangents.size())
+            throw std::length_error("The number of tangents doesn't match the number of points.");
+
+        const std::size_t num_segments = points.size() < 2 ? 0 : points.size() - 1;
+        detail::Curves::CheckSplineSizes(num_segments, params.size(), out.size());
+
+        for (std::size_t i = 0; i < params.size(); i++)
+        {
+            auto u = params[i];
+            std::size_t s = detail::Curves::SplitParam(u, num_segments);
+            out[i] = cubic_curve<V>::from_hermite(points[s], tangents[s], points[s + 1], tangents[s + 1])(u);
+        }
+    }
+
+    // Evaluates a uniform Catmull-Rom spline. It passes through all `points` except the first and the last one, which only affect the tangents.
+    // Each `params[i]` is in range `[0, points.size() - 3]` (out-of-range values are clamped), the integral part selects the segment.
+    template <typename V>
+    constexpr void eval_catmull_rom_spline(std::span<const V> points, std::span<const typename cubic_curve<V>::param_type> params, std::span<V> out)
+    {
+        const std::size_t num_segments = points.size() < 4 ? 0 : points.size() - 3;
+        detail::Curves::CheckSplineSizes(num_segments, params.size(), out.size());
+
+        for (std::size_t i = 0; i < params.size(); i++)
+        {
+            auto u = params[i];
+            const V *p = &points[detail::Curves::SplitParam(u, num_segments)];
+            out[i] = cubic_curve<V>::from_catmull_rom(p[0], p[1], p[2], p[3])(u);
+        }
+    }
+
+    inline namespace Common
+    {
+        using Math::cubic_curve;
+    }
+}
@@ -0,0 +1,407 @@
+#pragma once
+
+#include "em/math/namespaces.h"
+#include "em/math/scalar.h"
+#include "em/math/vector.h"
+#include "em/math/vector_traits.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// A compact encoding for streams of integer vectors (or integers) that change a little at a time, e.g. positions sent over the network each tick.
+// Each vector is replaced with the difference from the previous one, for each component separately, and those are stored with as few bits as possible.
+//
+// The format of one `encode()` call:
+//   * The number of vectors, as a LEB128 varint.
+//   * The blocks of up to `block_size` vectors. For each block:
+//     * One byte per component, the bit width of the values of that component in this block.
+//     * For each component, the values packed with that width, least significant bits first, padded to a whole byte.
+//   The values are the zigzag-encoded differences (0, -1, 1, -2, 2... map to 0, 1, 2, 3, 4...), so small negative differences stay small.
+
+namespace em::Math
+{
+    namespace detail::DeltaCodec
+    {
+        template <typename T>
+        concept Scalar = integral_scalar<T> && !std::is_same_v<T, bool> && sizeof(T) <= 8;
+
+        // Maps the differences to unsigned integers so that the small negative ones are small too.
+        template <std::unsigned_integral U>
+        [[nodiscard]] constexpr U ZigzagEncode(U delta)
+        {
+            return U(U(delta << 1) ^ U(std::make_signed_t<U>(delta) >> (std::numeric_limits<U>::digits - 1)));
+        }
+        template <std::unsigned_integral U>
+        [[nodiscard]] constexpr U ZigzagDecode(U value)
+        {
+            return U(U(value >> 1) ^ U(-U(value & 1)));
+        }
+
+        // Writes and reads the low `num_bytes` bytes of the word, little-endian.
+        // The full words are copied with `memcpy()` on little-endian machines, the compilers don't always merge the byte loops.
+        constexpr void StoreWord(std::byte *out, std::uint64_t word, std::size_t num_bytes = 8)
+        {
+            if (!std::is_constant_evaluated() && std::endian::native == std::endian::little && num_bytes == 8)
+            {
+                std::memcpy(out, &word, 8);
+                return;
+            }
+            for (std::size_t i = 0; i < num_bytes; i++)
+                out[i] = std::byte(word >> (i * 8));
+        }
+        [[nodiscard]] constexpr std::uint64_t LoadWord(const std::byte *in, std::size_t num_bytes = 8)
+        {
+            std::uint64_t ret = 0;
+            if (!std::is_constant_evaluated() && std::endian::native == std::endian::little && num_bytes == 8)
+            {
+                std::memcpy(&ret, in, 8);
+                return ret;
+            }
+            for (std::size_t i = 0; i < num_bytes; i++)
+                ret |= std::uint64_t(in[i]) << (i * 8);
+            return ret;
+        }
+
+        // How many bytes `count` values take when packed with `width` bits each.
+        [[nodiscard]] constexpr std::size_t PackedSize(std::size_t count, int width)
+        {
+            return (count * std::size_t(width) + 7) / 8;
+        }
+
+        // Packs `values` with `Width` bits each. Returns the number of written bytes, which is `PackedSize(values.size(), Width)`.
+        // The width is a template parameter, so the shifts and masks are constants.
+        template <int Width, typename U>
+        constexpr std::size_t PackFixed(std::span<const U> values, std::byte *out)
+        {
+            if constexpr (Width == 0)
+            {
+                return 0;
+            }
+            else
+            {
+                std::byte *cur = out;
+                std::uint64_t word = 0;
+                int num_bits = 0;
+                for (U value : values)
+                {
+                    word |= std::uint64_t(value) << num_bits;
+                    num_bits += Width;
+                    if (num_bits >= 64)
+                    {
+                        StoreWord(cur, word);
+                        cur += 8;
+                        num_bits -= 64;
+                        // The bits of `value` that didn't fit.
+                        word = num_bits > 0 ? std::uint64_t(value) >> (Width - num_bits) : 0;
+                    }
+                }
+                const std::size_t tail = std::size_t(num_bits + 7) / 8;
+                StoreWord(cur, word, tail);
+                return std::size_t(cur - out) + tail;
+            }
+        }
+
+        // The opposite of `PackFixed()`. Reads exactly `PackedSize(values.size(), Width)` bytes from `in`.
+        template <int Width, typename U>
+        constexpr void UnpackFixed(const std::byte *in, std::span<U> values)
+        {
+            if constexpr (Width == 0)
+            {
+                std::fill(values.begin(), values.end(), U(0));
+            }
+            else
+            {
+                constexpr std::uint64_t mask = Width == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << Width) - 1;
+                const std::size_t packed_size = PackedSize(values.size(), Width);
+
+                // Each value is read from the 8 bytes starting at its first byte, independently from the others, so there's no dependency
+                //   between the iterations. This needs the value to fit into those bytes after the shift.
+                if constexpr (Width <= 57)
+                {
+                    // The values whose 8 bytes are not all in the input are read from a zero-padded copy of the last bytes.
+                    const std::size_t num_direct = packed_size < 8 ? 0 : std::min(values.size(), ((packed_size - 8) * 8) / Width + 1);
+                    for (std::size_t i = 0; i < num_direct; i++)
+                    {
+                        const std::size_t bit = i * Width;
+                        values[i] = U((LoadWord(in + bit / 8) >> (bit % 8)) & mask);
+                    }
+
+                    if (num_direct < values.size())
+                    {
+                        const std::size_t tail_begin = num_direct * Width / 8;
+                        std::byte tail[16]{};
+                        std::copy(in + tail_begin, in + packed_size, tail);
+                        for (std::size_t i = num_direct; i < values.size(); i++)
+                        {
+                            const std::size_t bit = i * Width;
+                            values[i] = U((LoadWord(tail + (bit / 8 - tail_begin)) >> (bit % 8)) & mask);
+                        }
+                    }
+                }
+                else
+                {
+                    // Wider values can span 9 bytes, read them sequentially.
+                    const std::byte *const end = in + packed_size;
+                    std::uint64_t word = 0;
+                    int num_bits = 0; // The number of unread bits in `word`.
+                    for (U &value : values)
+                    {
+                        if (num_bits >= Width)
+                        {
+                            value = U(word & mask);
+                            word = Width == 64 ? 0 : word >> (Width % 64);
+                            num_bits -= Width;
+                        }
+                        else
+                        {
+                            const std::size_t num_bytes = std::min(std::size_t(end - in), std::size_t(8));
+                            const std::uint64_t next = LoadWord(in, num_bytes);
+                            in += num_bytes;
+                            // `num_bits < Width <= 64`, so the shifts are fine.
+                            value = U((word | (next << num_bits)) & mask);
+                            const int used = Width - num_bits;
+                            word = used == 64 ? 0 : next >> used;
+                            num_bits = int(num_bytes * 8) - used;
+                        }
+                    }
+                }
+            }
+        }
+
+        // Calls `func.template operator()<Width>()` with the runtime `width` turned into a constant.
+        template <typename U, typename F>
+        constexpr decltype(auto) DispatchWidth(int width, F &&func)
+        {
+            return [&]<int ...I>(std::integer_sequence<int, I...>) -> decltype(auto)
+            {
+                using R = decltype(func.template operator()<0>());
+                if constexpr (std::is_void_v<R>)
+                {
+                    (void)((width == I && (func.template operator()<I>(), true)) || ...);
+                }
+                else
+                {
+                    R ret{};
+                    (void)((width == I && (ret = func.template operator()<I>(), true)) || ...);
+                    return ret;
+                }
+            }(std::make_integer_sequence<int, std::numeric_limits<U>::digits + 1>{});
+        }
+
+        // Packs `values` with `width` bits each. Returns the number of written bytes.
+        template <typename U>
+        constexpr std::size_t Pack(std::span<const U> values, int width, std::byte *out)
+        {
+            return DispatchWidth<U>(width, [&]<int Width>{return PackFixed<Width>(values, out);});
+        }
+
+        // The opposite of `Pack()`.
+        template <typename U>
+        constexpr void Unpack(const std::byte *in, int width, std::span<U> values)
+        {
+            DispatchWidth<U>(width, [&]<int Width>{UnpackFixed<Width>(in, values);});
+        }
+
+        [[nodiscard]] constexpr std::size_t VarintSize(std::uint64_t value)
+        {
+            return std::size_t(std::max(1, (int(std::bit_width(value)) + 6) / 7));
+        }
+    }
+
+    // Delta-encodes a stream of integer vectors (or integers). Keeps the last vector between the calls, so the stream can be encoded in parts.
+    // Decode with a `delta_decoder` of the same type, calling `decode()` once per each `encode()` call, in the same order.
+    template <vector_or_scalar V> requires detail::DeltaCodec::Scalar<vec_base_t<V>>
+    class delta_encoder
+    {
+      public:
+        using elem_type = vec_base_t<V>;
+        using unsigned_type = std::make_unsigned_t<elem_type>;
+        static constexpr int dims = vec_size<V>;
+
+        // The number of vectors per block, that share the bit widths.
+        // Larger blocks have less overhead, smaller blocks adapt better to the outliers.
+        static constexpr std::size_t block_size = 128;
+
+      private:
+        V previous{};
+
+      public:
+        constexpr delta_encoder() {}
+
+        // The first vector is encoded relative to this.
+        constexpr delta_encoder(const V &previous) : previous(previous) {}
+
+        // Forgets the previous vector. The decoder must be reset at the same point.
+        constexpr void reset(const V &new_previous = {}) {previous = new_previous;}
+
+        // The max size of the output of `encode()` for this many vectors.
+        [[nodiscard]] static constexpr std::size_t max_encoded_size(std::size_t count)
+        {
+            const std::size_t num_blocks = (count + block_size - 1) / block_size;
+            return detail::DeltaCodec::VarintSize(count) + num_blocks * dims + count * dims * sizeof(elem_type);
+        }
+
+        // Encodes `input` into `output`, which must have room for `max_encoded_size(input.size())` bytes. Returns the number of written bytes.
+        constexpr std::size_t encode(std::span<const V> input, std::span<std::byte> output)
+        {
+            if (output.size() < max_encoded_size(input.size()))
+                throw std::length_error("The output buffer for delta encoding is too small.");
+
+            std::byte *cur = output.data();
+
+            for (std::uint64_t n = input.size(); true;)
+            {
+                *cur++ = std::byte((n & 0x7f) | (n > 0x7f ? 0x80 : 0));
+                n >>= 7;
+                if (n == 0)
+                    break;
+            }
+
+            unsigned_type values[dims][block_size];
+
+            for (std::size_t block_begin = 0; block_begin < input.size(); block_begin += block_size)
+            {
+                const std::size_t n = std::min(block_size, input.size() - block_begin);
+
+                // The zigzagged differences, one component at a time, so the loops are simple.
+                // The widths are computed from the OR of all values, which is as good as the max and vectorizes better.
+                unsigned_type bits_used[dims]{};
+                for (int j = 0; j < dims; j++)
+                {
+                    unsigned_type prev = unsigned_type(vec_elem(j, previous));
+                    for (std::size_t i = 0; i < n; i++)
+                    {
+                        const unsigned_type cur_value = unsigned_type(vec_elem(j, input[block_begin + i]));
+                        values[j][i] = detail::DeltaCodec::ZigzagEncode(unsigned_type(cur_value - prev));
+                        bits_used[j] |= values[j][i];
+                        prev = cur_value;
+                    }
+                }
+                previous = input[block_begin + n - 1];
+
+                for (int j = 0; j < dims; j++)
+                    *cur++ = std::byte(std::bit_width(bits_used[j]));
+                for (int j = 0; j < dims; j++)
+                    cur += detail::DeltaCodec::Pack(std::span<const unsigned_type>(values[j], n), int(std::bit_width(bits_used[j])), cur);
+            }
+
+            return std::size_t(cur - output.data());
+        }
+    };
+
+    // Decodes the output of `delta_encoder`.
+    template <vector_or_scalar V> requires detail::DeltaCodec::Scalar<vec_base_t<V>>
+    class delta_decoder
+    {
+      public:
+        using elem_type = vec_base_t<V>;
+        using unsigned_type = std::make_unsigned_t<elem_type>;
+        static constexpr int dims = vec_size<V>;
+        static constexpr std::size_t block_size = delta_encoder<V>::block_size;
+
+        struct result
+        {
+            // The number of bytes read from the input.
+            std::size_t num_bytes = 0;
+            // The number of vectors written to the output.
+            std::size_t count = 0;
+        };
+
+      private:
+        V previous{};
+
+        // Reads the vector count. Returns the number of bytes it takes.
+        [[nodiscard]] static constexpr std::size_t ReadCount(std::span<const std::byte> input, std::uint64_t &count)
+        {
+            count = 0;
+            for (std::size_t i = 0; i < input.size() && i < 10; i++)
+            {
+                count |= std::uint64_t(input[i] & std::byte(0x7f)) << (i * 7);
+                if ((input[i] & std::byte(0x80)) == std::byte(0))
+                    return i + 1;
+            }
+            throw std::runtime_error("Invalid vector count in the delta-encoded data.");
+        }
+
+      public:
+        constexpr delta_decoder() {}
+
+        // Must match the encoder.
+        constexpr delta_decoder(const V &previous) : previous(previous) {}
+
+        constexpr void reset(const V &new_previous = {}) {previous = new_previous;}
+
+        // Returns the number of vectors in the output of one `encode()` call, starting at the beginning of `input`.
+        [[nodiscard]] static constexpr std::size_t encoded_count(std::span<const std::byte> input)
+        {
+            std::uint64_t count = 0;
+            (void)ReadCount(input, count);
+            return std::size_t(count);
+        }
+
+        // Decodes the output of one `encode()` call from the beginning of `input` into `output`, which must have room for `encoded_count(input)` vectors.
+        // Throws if the data is invalid or truncated.
+        constexpr result decode(std::span<const std::byte> input, std::span<V> output)
+        {
+            std::uint64_t count = 0;
+            std::size_t pos = ReadCount(input, count);
+            if (output.size() < count)
+                throw std::length_error("The output buffer for delta decoding is too small.");
+
+            unsigned_type values[dims][block_size];
+
+            for (std::size_t block_begin = 0; block_begin < count; block_begin += block_size)
+            {
+                const std::size_t n = std::min(block_size, std::size_t(count) - block_begin);
+
+                if (input.size() - pos < std::size_t(dims))
+                    throw std::runtime_error("The delta-encoded data is truncated.");
+                int widths[dims];
+                std::size_t packed_size = 0;
+                for (int j = 0; j < dims; j++)
+                {
+                    widths[j] = int(input[pos++]);
+                    if (widths[j] > std::numeric_limits<unsigned_type>::digits)
+                        throw std::runtime_error("Invalid bit width in the delta-encoded data.");
+                    packed_size += detail::DeltaCodec::PackedSize(n, widths[j]);
+                }
+                if (input.size() - pos < packed_size)
+                    throw std::runtime_error("The delta-encoded data is truncated.");
+
+                for (int j = 0; j < dims; j++)
+                {
+                    detail::DeltaCodec::Unpack(input.data() + pos, widths[j], std::span<unsigned_type>(values[j], n));
+                    pos += detail::DeltaCodec::PackedSize(n, widths[j]);
+                }
+
+                // The running sums of the differences, one component at a time.
+                for (int j = 0; j < dims; j++)
+                {
+                    unsigned_type sum = unsigned_type(vec_elem(j, previous));
+                    for (std::size_t i = 0; i < n; i++)
+                    {
+                        sum = unsigned_type(sum + detail::DeltaCodec::ZigzagDecode(values[j][i]));
+                        vec_elem(j, output[block_begin + i]) = elem_type(sum);
+                    }
+                }
+                previous = output[block_begin + n - 1];
+            }
+
+            return {pos, std::size_t(count)};
+        }
+    };
+
+    inline namespace Common
+    {
+        using Math::delta_decoder;
+        using Math::delta_encoder;
+    }
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "em/macros/portable/if_consteval.h"
 #include "em/macros/utils/returns.h"
 #include "em/math/apply_elementwise.h"
 #include "em/math/larger_type.h"
@@ -7,6 +8,8 @@
 #include "em/math/scalar.h"
 
 #include <cmath>
+#include <concepts>
+#include <limits>
 
 namespace em::Math
 {
@@ -91,6 +94,62 @@ namespace em::Math
         EM_WRAP_ADL_FUNCTION(std, modf)
         EM_WRAP_ADL_FUNCTION(std, nextafter)
         EM_WRAP_ADL_FUNCTION(std, pow)
+        EM_WRAP_ADL_FUNCTION(std, sqrt)
+        EM_WRAP_ADL_FUNCTION(std, fma)
+
+        // Whether `std::fma()` is backed by a hardware instruction for this type.
+        // If it isn't, it's a slow library call (emulated with extra precision), and we're better off with `a * b + c`.
+        template <typename T> constexpr bool HaveFastFma = false;
+        #ifdef FP_FAST_FMAF
+        template <> constexpr bool HaveFastFma<float> = true;
+        #endif
+        #ifdef FP_FAST_FMA
+        template <> constexpr bool HaveFastFma<double> = true;
+        #endif
+        #ifdef FP_FAST_FMAL
+        template <> constexpr bool HaveFastFma<long double> = true;
+        #endif
+
+        // `a * b` with no rounding, as the rounded product and the error. Exact unless something overflows or underflows.
+        // Unlike `fma(a, b, -product)` below, this doesn't silently give a zero error when there's no hardware FMA or in constant evaluation.
+        template <std::floating_point T>
+        constexpr void TwoProduct(T a, T b, T &product, T &error)
+        {
+            product = a * b;
+
+            // Dekker's algorithm, which needs the multiplications to not be fused with the additions. Without a hardware FMA they can't be.
+            auto dekker = [&]
+            {
+                // Splits `x` into two halves of at most `digits / 2` bits, so that the products of the halves are exact.
+                constexpr T splitter = T((1ull << ((std::numeric_limits<T>::digits + 1) / 2)) + 1);
+                auto split = [](T x, T &hi, T &lo)
+                {
+                    const T c = splitter * x;
+                    hi = c - (c - x);
+                    lo = x - hi;
+                };
+                T a_hi, a_lo, b_hi, b_lo;
+                split(a, a_hi, a_lo);
+                split(b, b_hi, b_lo);
+                error = a_lo * b_lo - (((product - a_hi * b_hi) - a_lo * b_hi) - a_hi * b_lo);
+            };
+
+            if constexpr (HaveFastFma<T>)
+            {
+                EM_IF_CONSTEVAL
+                {
+                    dekker();
+                }
+                else
+                {
+                    error = fma_(a, b, -product);
+                }
+            }
+            else
+            {
+                dekker();
+            }
+        }
     }
 
     // Absolute value.
@@ -103,6 +162,24 @@ namespace em::Math
         (template <integral_scalar I = int>), (EM_1<I>),, (const floating_point_scalar auto &a) EM_RETURNS(I(detail::Funcs::round_(a)))
     )
 
+    // Round towards minus infinity, to an integral type. Unlike `floor()`, this is usable in constexpr, and is cheaper than `I(floor(a))`.
+    // The result must be representable in `I`.
+    EM_SIMPLE_ELEMENTWISE_FUNCTOR_EXT( ifloor,
+        (template <integral_scalar I = int>), (EM_1<I>),, (const floating_point_scalar auto &a)
+        {
+            I i = I(a);
+            return I(i - (a < i));
+        }
+    )
+    // Round towards plus infinity, to an integral type. Same notes as for `ifloor()`.
+    EM_SIMPLE_ELEMENTWISE_FUNCTOR_EXT( iceil,
+        (template <integral_scalar I = int>), (EM_1<I>),, (const floating_point_scalar auto &a)
+        {
+            I i = I(a);
+            return I(i + (a > i));
+        }
+    )
+
     // Round away from zero.
     EM_SIMPLE_ELEMENTWISE_FUNCTOR( round_maxabs,, (const floating_point_scalar auto &a) EM_RETURNS(a < 0 ? detail::Funcs::floor_(a) : detail::Funcs::ceil_(a)))
     // Round towards minus infinity.
@@ -125,6 +202,70 @@ namespace em::Math
     // Floating-point power.
     EM_SIMPLE_ELEMENTWISE_FUNCTOR( pow, (template <scalar T>), (const T &a, const T &b) EM_RETURNS(detail::Funcs::pow_(a, b)))
 
+    // Square root. Integers are converted to floating-point first.
+    EM_SIMPLE_ELEMENTWISE_FUNCTOR( sqrt,, (const scalar auto &a) EM_RETURNS(detail::Funcs::sqrt_(floating_point_t<std::remove_cvref_t<decltype(a)>>(a))))
+
+    // Fused multiply-add, `a * b + c`.
+    // Uses `std::fma()` only if the target has a hardware FMA for this type, otherwise uses the plain expression (which the compiler is free to contract).
+    // So don't rely on this being rounded only once.
+    EM_SIMPLE_ELEMENTWISE_FUNCTOR( fma,
+        (template <scalar A, scalar B, scalar C, typename L = larger_t<A, B, C>>),
+        (const A &a, const B &b, const C &c)
+        {
+            if constexpr (detail::Funcs::HaveFastFma<L>)
+            {
+                EM_IF_CONSTEVAL
+                {
+                    return L(L(a) * L(b) + L(c));
+                }
+                else
+                {
+                    return L(detail::Funcs::fma_(L(a), L(b), L(c)));
+                }
+            }
+            else
+            {
+                return L(L(a) * L(b) + L(c));
+            }
+        }
+    )
+
+
+    // Linear interpolation. Returns `a` for `t == 0` and `b` for `t == 1`. Always returns a floating-point type.
+    // This is `a - t * a + t * b` with two FMAs, which is exact at both ends, unlike the more common `a + (b - a) * t`.
+    EM_SIMPLE_ELEMENTWISE_FUNCTOR( lerp,
+        (template <scalar A, scalar B, scalar T, typename F = floating_point_t<larger_t<A, B, T>>>),
+        (const A &a, const B &b, const T &t) EM_RETURNS(fma(F(t), F(b), fma(-F(t), F(a), F(a))))
+    )
+
+    // The inverse of `lerp()`. Returns `0` for `x == a` and `1` for `x == b`. Doesn't clamp.
+    // If `a == b`, returns NaN or infinity.
+    EM_SIMPLE_ELEMENTWISE_FUNCTOR( inverse_lerp,
+        (template <scalar A, scalar B, scalar X, typename F = floating_point_t<larger_t<A, B, X>>>),
+        (const A &a, const B &b, const X &x) EM_RETURNS((F(x) - F(a)) / (F(b) - F(a)))
+    )
+
+    // Hermite interpolation between `0` at `x <= edge0` and `1` at `x >= edge1`, same as in GLSL.
+    // If `edge0 == edge1`, the result is unspecified.
+    EM_SIMPLE_ELEMENTWISE_FUNCTOR( smoothstep,
+        (template <scalar A, scalar B, scalar X, typename F = floating_point_t<larger_t<A, B, X>>>),
+        (const A &edge0, const B &edge1, const X &x)
+        {
+            F t = clamp(inverse_lerp(edge0, edge1, x), F(0), F(1));
+            return t * t * fma(F(-2), t, F(3));
+        }
+    )
+
+    // Same as `smoothstep()`, but also has zero second derivative at the ends (Perlin's `6t^5 - 15t^4 + 10t^3`).
+    EM_SIMPLE_ELEMENTWISE_FUNCTOR( smootherstep,
+        (template <scalar A, scalar B, scalar X, typename F = floating_point_t<larger_t<A, B, X>>>),
+        (const A &edge0, const B &edge1, const X &x)
+        {
+            F t = clamp(inverse_lerp(edge0, edge1, x), F(0), F(1));
+            return t * t * t * fma(t, fma(t, F(6), F(-15)), F(10));
+        }
+    )
+
 
     // Integer division, modified for negative values of `a` to be periodic:
     //           i : -4  -3  -2  -1  0  1  2  3  4
@@ -183,6 +324,8 @@ namespace em::Math
         using Math::abs;
         using Math::round;
         using Math::iround;
+        using Math::ifloor;
+        using Math::iceil;
         using Math::round_maxabs;
         using Math::floor;
         using Math::ceil;
@@ -190,6 +333,12 @@ namespace em::Math
         using Math::frac;
         using Math::modf;
         using Math::nextafter;
+        using Math::sqrt;
+        using Math::fma;
+        using Math::lerp;
+        using Math::inverse_lerp;
+        using Math::smoothstep;
+        using Math::smootherstep;
         using Math::div_ex;
         using Math::mod_ex;
         using Math::div_maxabs;
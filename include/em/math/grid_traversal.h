@@ -0,0 +1,257 @@
+#pragma once
+
+#include "em/math/functions.h"
+#include "em/math/namespaces.h"
+#include "em/math/parallel.h"
+#include "em/math/ray.h"
+#include "em/math/scalar.h"
+#include "em/math/vector.h"
+
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+// Walking grid cells along lines: the Amanatides-Woo voxel traversal for rays, and Bresenham lines between integer points.
+// Both are ranges that don't allocate, usable with range-based `for`.
+
+namespace em::Math
+{
+    // One cell visited by `voxel_traversal`, and the range of ray distances inside of it.
+    template <floating_point_scalar T, int N>
+    struct voxel_traversal_cell
+    {
+        vec<int, N> cell;
+        T t_enter = 0;
+        T t_exit = 0;
+    };
+
+    // Visits every cell of size `cell_size` that the ray passes through, for the distances in `[t_min, t_max]`, in order.
+    // The cells the ray only touches at a single point (e.g. when starting exactly on a boundary and moving away from it) are skipped,
+    //   except when the ray passes exactly through a corner, then the cells are stepped into one axis at a time, lower axis first.
+    // Zero direction components are fine, the ray never leaves its cell along those axes.
+    // If `t_max` is infinite, this never ends, so break out of the loop yourself.
+    template <floating_point_scalar T, int N = 3>
+    class voxel_traversal
+    {
+        vec<T, N> origin;
+        vec<T, N> dir;
+        T cell_len = 1;
+        T t_begin = 0;
+        T t_end = 0;
+
+      public:
+        using value_type = voxel_traversal_cell<T, N>;
+
+        // Batches with less than this many rays per thread use fewer threads.
+        static constexpr std::size_t min_rays_per_thread = 64;
+
+        constexpr voxel_traversal() {}
+        constexpr voxel_traversal(const ray<T, N> &r, std::type_identity_t<T> t_min, std::type_identity_t<T> t_max, std::type_identity_t<T> cell_size = 1)
+            : origin(r.origin), dir(r.dir), cell_len(cell_size), t_begin(t_min), t_end(t_max)
+        {}
+
+        // Visits the cells from `a` to `b`. The distances are then in `[0, 1]`.
+        [[nodiscard]] static constexpr voxel_traversal segment(const vec<T, N> &a, const vec<T, N> &b, std::type_identity_t<T> cell_size = 1)
+        {
+            return voxel_traversal(ray<T, N>{a, b - a}, 0, 1, cell_size);
+        }
+
+        class iterator
+        {
+            const voxel_traversal *self = nullptr;
+            voxel_traversal_cell<T, N> cur;
+            // -1, 0 or 1 for each axis.
+            vec<int, N> step;
+            // The distances at which the ray crosses the next boundary on each axis.
+            vec<T, N> t_next;
+            bool done = true;
+
+            // The distance at which the ray leaves the current cell along `axis`.
+            [[nodiscard]] constexpr T NextBoundary(int axis) const
+            {
+                if (step[axis] == 0)
+                    return std::numeric_limits<T>::infinity();
+                // Computing this from scratch instead of adding a delta each time, so the errors don't accumulate.
+                return (T(cur.cell[axis] + (step[axis] > 0)) * self->cell_len - self->origin[axis]) / self->dir[axis];
+            }
+
+            constexpr void UpdateExit()
+            {
+                cur.t_exit = self->t_end;
+                for (int i = 0; i < N; i++)
+                    cur.t_exit = t_next[i] < cur.t_exit ? t_next[i] : cur.t_exit;
+                cur.t_exit = cur.t_exit < cur.t_enter ? cur.t_enter : cur.t_exit;
+            }
+
+          public:
+            using value_type = voxel_traversal_cell<T, N>;
+            using difference_type = std::ptrdiff_t;
+
+            constexpr iterator() {}
+
+            constexpr iterator(const voxel_traversal &target) : self(&target)
+            {
+                if (!(self->t_begin <= self->t_end))
+                    return;
+                done = false;
+
+                cur.t_enter = self->t_begin;
+                for (int i = 0; i < N; i++)
+                {
+                    const T x = (self->origin[i] + self->dir[i] * self->t_begin) / self->cell_len;
+                    // When moving in the negative direction from exactly a boundary, we start in the lower cell, since we spend no time in the upper one.
+                    step[i] = (self->dir[i] > 0) - (self->dir[i] < 0);
+                    cur.cell[i] = step[i] < 0 ? iceil(x) - 1 : ifloor(x);
+                    t_next[i] = NextBoundary(i);
+                }
+                UpdateExit();
+            }
+
+            [[nodiscard]] constexpr const value_type &operator*() const {return cur;}
+            [[nodiscard]] constexpr const value_type *operator->() const {return &cur;}
+
+            constexpr iterator &operator++()
+            {
+                int axis = 0;
+                for (int i = 1; i < N; i++)
+                {
+                    if (t_next[i] < t_next[axis])
+                        axis = i;
+                }
+
+                // Not entering the cells that the end point only touches. This also stops when all direction components are zero.
+                if (!(t_next[axis] < self->t_end))
+                {
+                    done = true;
+                    return *this;
+                }
+
+                cur.cell[axis] += step[axis];
+                cur.t_enter = t_next[axis] > cur.t_enter ? t_next[axis] : cur.t_enter;
+                t_next[axis] = NextBoundary(axis);
+                UpdateExit();
+                return *this;
+            }
+            constexpr iterator operator++(int)
+            {
+                iterator ret = *this;
+                ++*this;
+                return ret;
+            }
+
+            [[nodiscard]] constexpr bool operator==(std::default_sentinel_t) const
+            {
+                return done;
+            }
+        };
+
+        [[nodiscard]] constexpr iterator begin() const {return iterator(*this);}
+        [[nodiscard]] constexpr std::default_sentinel_t end() const {return {};}
+
+        // Traverses many rays at once, with the same distance range and cell size, splitting them between threads.
+        // Calls `func(ray_index, cell)` for each visited cell, where `cell` is a `value_type`. Return `false` from it to stop traversing this ray.
+        // `func` is called concurrently for different rays, and in order for each ray. `num_threads == 0` means `std::thread::hardware_concurrency()`.
+        template <typename F>
+        static constexpr void for_each_batch(std::span<const ray<T, N>> rays, std::type_identity_t<T> t_min, std::type_identity_t<T> t_max, std::type_identity_t<T> cell_size, F &&func, int num_threads = 0)
+        {
+            parallel_for(rays.size(), num_threads, min_rays_per_thread, [&](int, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; i++)
+                {
+                    for (const value_type &cell : voxel_traversal(rays[i], t_min, t_max, cell_size))
+                    {
+                        if (!func(i, cell))
+                            break;
+                    }
+                }
+            });
+        }
+    };
+
+    // Visits the integer points on a line from `a` to `b`, both inclusive, using Bresenham's algorithm.
+    // Consecutive points are 8-connected. The line from `b` to `a` can visit different points than the one from `a` to `b`.
+    // The coordinate differences must fit into `int` when doubled.
+    class bresenham_line
+    {
+        vec2<int> a;
+        vec2<int> b;
+
+      public:
+        constexpr bresenham_line() {}
+        constexpr bresenham_line(vec2<int> a, vec2<int> b) : a(a), b(b) {}
+
+        class iterator
+        {
+            vec2<int> pos;
+            vec2<int> target;
+            vec2<int> step;
+            // `abs(target.x - pos.x)`, and `-abs(target.y - pos.y)` for the initial position.
+            vec2<int> delta;
+            int error = 0;
+            bool done = true;
+
+          public:
+            using value_type = vec2<int>;
+            using difference_type = std::ptrdiff_t;
+
+            constexpr iterator() {}
+
+            constexpr iterator(const bresenham_line &line)
+                : pos(line.a), target(line.b), done(false)
+            {
+                const vec2<int> d = line.b - line.a;
+                step = vec2<int>(d.x < 0 ? -1 : 1, d.y < 0 ? -1 : 1);
+                delta = vec2<int>(d.x < 0 ? -d.x : d.x, d.y < 0 ? d.y : -d.y);
+                error = delta.x + delta.y;
+            }
+
+            [[nodiscard]] constexpr const vec2<int> &operator*() const {return pos;}
+            [[nodiscard]] constexpr const vec2<int> *operator->() const {return &pos;}
+
+            constexpr iterator &operator++()
+            {
+                if (pos == target)
+                {
+                    done = true;
+                    return *this;
+                }
+
+                const int e2 = error * 2;
+                if (e2 >= delta.y)
+                {
+                    error += delta.y;
+                    pos.x += step.x;
+                }
+                if (e2 <= delta.x)
+                {
+                    error += delta.x;
+                    pos.y += step.y;
+                }
+                return *this;
+            }
+            constexpr iterator operator++(int)
+            {
+                iterator ret = *this;
+                ++*this;
+                return ret;
+            }
+
+            [[nodiscard]] constexpr bool operator==(std::default_sentinel_t) const
+            {
+                return done;
+            }
+        };
+
+        [[nodiscard]] constexpr iterator begin() const {return iterator(*this);}
+        [[nodiscard]] constexpr std::default_sentinel_t end() const {return {};}
+    };
+
+    inline namespace Common
+    {
+        using Math::voxel_traversal;
+        using Math::voxel_traversal_cell;
+        using Math::bresenham_line;
+    }
+}
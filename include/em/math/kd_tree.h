@@ -0,0 +1,298 @@
+#pragma once
+
+#include "em/math/namespaces.h"
+#include "em/math/parallel.h"
+#include "em/math/scalar.h"
+#include "em/math/vector.h"
+#include "em/math/vector_functions.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+// A k-d tree over points, for nearest neighbor and radius queries.
+
+namespace em::Math
+{
+    // One result of `kd_tree::find_nearest()`.
+    template <floating_point_scalar T>
+    struct kd_tree_neighbor
+    {
+        // The index of the point in the array the tree was built from.
+        std::uint32_t index = 0;
+        // The squared distance to it.
+        T dist_sq = 0;
+
+        [[nodiscard]] friend constexpr bool operator==(const kd_tree_neighbor &, const kd_tree_neighbor &) = default;
+    };
+
+    // An immutable k-d tree, built by splitting the points at the median of the longest axis. The points are copied into the tree.
+    // Holds on to its memory, so rebuilding doesn't allocate.
+    // All distances are squared, like in `length_sq()`.
+    // The number of points is limited to `2^32 - 1`.
+    template <floating_point_scalar T, int N = 3>
+    class kd_tree
+    {
+      public:
+        using type = T;
+        static constexpr int dims = N;
+        using neighbor = kd_tree_neighbor<T>;
+
+        struct node
+        {
+            // For other nodes, the split position along `axis`. The left child has the points with smaller or equal coordinates, the right one with greater or equal.
+            T split = 0;
+            // The split axis, or -1 for leaves.
+            int axis = -1;
+            // For leaves, the first element of `points()` belonging to this leaf. For other nodes, the left child, followed by the right child.
+            std::uint32_t first = 0;
+            // The number of points in a leaf.
+            std::uint32_t count = 0;
+
+            [[nodiscard]] constexpr bool is_leaf() const {return axis == -1;}
+        };
+
+        // Leaves have at most this many points.
+        static constexpr std::uint32_t max_leaf_size = 8;
+        // Inputs with less than this many points per thread use fewer threads.
+        static constexpr std::size_t min_elements_per_thread = 1 << 12;
+        // Batches with less than this many queries per thread use fewer threads.
+        static constexpr std::size_t min_queries_per_thread = 256;
+
+      private:
+        // The stack size for the queries. The tree is balanced, so its depth is at most about 30.
+        static constexpr int max_stack_size = 64;
+
+        // The root is the first node, and the children always come after their parents.
+        std::vector<node> node_list;
+        // The points, reordered so that each leaf is contiguous.
+        std::vector<vec<T, N>> tree_points;
+        // The original indices of `tree_points`.
+        std::vector<std::uint32_t> point_indices;
+
+        using Task = detail::Parallel::SubtreeTask;
+
+        // Builds the subtree for `[begin, end)` of `point_indices` into `out[node_index]`, appending the children to `out`.
+        // If `tasks` isn't null, the subtrees with at most `task_size` points are added to it instead of being built.
+        constexpr void BuildNode(std::span<const vec<T, N>> points, std::vector<node> &out, std::uint32_t node_index, std::size_t begin, std::size_t end, std::size_t task_size, std::vector<Task> *tasks)
+        {
+            const std::size_t count = end - begin;
+
+            if (count <= max_leaf_size)
+            {
+                out[node_index] = {.split = 0, .axis = -1, .first = std::uint32_t(begin), .count = std::uint32_t(count)};
+                return;
+            }
+
+            if (tasks && count <= task_size)
+            {
+                tasks->push_back({node_index, begin, end});
+                return;
+            }
+
+            vec<T, N> low(std::numeric_limits<T>::infinity());
+            vec<T, N> high(-std::numeric_limits<T>::infinity());
+            for (std::size_t i = begin; i < end; i++)
+            {
+                const vec<T, N> &p = points[point_indices[i]];
+                for (int j = 0; j < N; j++)
+                {
+                    low[j] = p[j] < low[j] ? p[j] : low[j];
+                    high[j] = p[j] > high[j] ? p[j] : high[j];
+                }
+            }
+            int axis = 0;
+            for (int j = 1; j < N; j++)
+            {
+                if (high[j] - low[j] > high[axis] - low[axis])
+                    axis = j;
+            }
+
+            const std::size_t mid = begin + count / 2;
+            std::nth_element(point_indices.begin() + std::ptrdiff_t(begin), point_indices.begin() + std::ptrdiff_t(mid), point_indices.begin() + std::ptrdiff_t(end), [&](std::uint32_t x, std::uint32_t y)
+            {
+                return points[x][axis] < points[y][axis];
+            });
+
+            const std::uint32_t left = std::uint32_t(out.size());
+            out.resize(out.size() + 2);
+            out[node_index] = {.split = points[point_indices[mid]][axis], .axis = axis, .first = left, .count = 0};
+            BuildNode(points, out, left, begin, mid, task_size, tasks);
+            BuildNode(points, out, left + 1, mid, end, task_size, tasks);
+        }
+
+        // Calls `func(i, dist_sq)` for every point `tree_points[i]` with `dist_sq <= max_dist_sq`.
+        // `func` can decrease `max_dist_sq` to skip more points. The nearer subtrees are visited first.
+        constexpr void Search(const vec<T, N> &point, T &max_dist_sq, auto &&func) const
+        {
+            if (node_list.empty())
+                return;
+
+            // The nodes to visit, and the lower bounds of the squared distances to them.
+            std::array<std::uint32_t, max_stack_size> stack;
+            std::array<T, max_stack_size> stack_dist_sq;
+            stack[0] = 0;
+            stack_dist_sq[0] = 0;
+            int stack_size = 1;
+
+            while (stack_size > 0)
+            {
+                stack_size--;
+                const T node_dist_sq = stack_dist_sq[std::size_t(stack_size)];
+                if (node_dist_sq > max_dist_sq)
+                    continue;
+                const node &n = node_list[stack[std::size_t(stack_size)]];
+
+                if (n.is_leaf())
+                {
+                    for (std::uint32_t i = n.first; i < n.first + n.count; i++)
+                    {
+                        const T d = distance_sq(point, tree_points[i]);
+                        if (d <= max_dist_sq)
+                            func(i, d);
+                    }
+                    continue;
+                }
+
+                const T diff = point[n.axis] - n.split;
+                const T plane_dist_sq = diff * diff;
+                const std::uint32_t near = diff < 0 ? n.first : n.first + 1;
+                const std::uint32_t far = diff < 0 ? n.first + 1 : n.first;
+
+                // Pushing the far child first, so the near one is visited first.
+                stack[std::size_t(stack_size)] = far;
+                stack_dist_sq[std::size_t(stack_size)] = plane_dist_sq > node_dist_sq ? plane_dist_sq : node_dist_sq;
+                stack_size++;
+                stack[std::size_t(stack_size)] = near;
+                stack_dist_sq[std::size_t(stack_size)] = node_dist_sq;
+                stack_size++;
+            }
+        }
+
+      public:
+        constexpr kd_tree() {}
+
+        // The nodes, starting from the root. Empty if there are no points.
+        [[nodiscard]] constexpr std::span<const node> nodes() const {return node_list;}
+        // The points in the tree order, which the leaves refer to.
+        [[nodiscard]] constexpr std::span<const vec<T, N>> points() const {return tree_points;}
+        // The original indices of `points()`.
+        [[nodiscard]] constexpr std::span<const std::uint32_t> indices() const {return point_indices;}
+        // The number of points.
+        [[nodiscard]] constexpr std::size_t size() const {return tree_points.size();}
+        [[nodiscard]] constexpr bool empty() const {return tree_points.empty();}
+
+        // Frees the memory.
+        constexpr void clear()
+        {
+            node_list = {};
+            tree_points = {};
+            point_indices = {};
+        }
+
+        // Builds the tree for those points, replacing the old contents.
+        // `num_threads == 0` means `std::thread::hardware_concurrency()`. The top levels are built on one thread, then the subtrees are built in parallel.
+        constexpr void build(std::span<const vec<T, N>> points, int num_threads = 0)
+        {
+            if (points.size() > std::numeric_limits<std::uint32_t>::max())
+                throw std::length_error("Too many points for the k-d tree.");
+
+            const std::size_t n = points.size();
+            node_list.clear();
+            point_indices.resize(n);
+            tree_points.resize(n);
+            if (n == 0)
+                return;
+
+            const int num_chunks = parallel_chunk_count(n, num_threads, min_elements_per_thread);
+            parallel_for_chunks(n, num_chunks, [&](int, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; i++)
+                    point_indices[i] = std::uint32_t(i);
+            });
+
+            // Several tasks per thread, so the threads that finish early don't idle for long.
+            const std::size_t task_size = num_chunks > 1 ? n / (std::size_t(num_chunks) * 4) : 0;
+            std::vector<Task> tasks;
+
+            node_list.resize(1);
+            BuildNode(points, node_list, 0, 0, n, task_size, num_chunks > 1 ? &tasks : nullptr);
+            // The tasks work on disjoint ranges of `point_indices`.
+            detail::Parallel::BuildSubtrees(node_list, tasks, num_chunks, [&](const Task &task, std::vector<node> &subtree)
+            {
+                BuildNode(points, subtree, 0, task.begin, task.end, 0, nullptr);
+            });
+
+            parallel_for_chunks(n, num_chunks, [&](int, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; i++)
+                    tree_points[i] = points[point_indices[i]];
+            });
+        }
+
+        // Finds up to `out.size()` nearest points with the squared distance at most `max_dist_sq`, and writes them to `out`, nearest first.
+        // Returns the number of points found.
+        constexpr std::size_t find_nearest(const vec<T, N> &point, std::span<neighbor> out, T max_dist_sq = std::numeric_limits<T>::infinity()) const
+        {
+            if (out.empty())
+                return 0;
+
+            // A max-heap of the best candidates so far.
+            auto farther = [](const neighbor &x, const neighbor &y){return x.dist_sq < y.dist_sq;};
+            std::size_t count = 0;
+            Search(point, max_dist_sq, [&](std::uint32_t i, T d)
+            {
+                if (count < out.size())
+                {
+                    out[count++] = {i, d};
+                    std::push_heap(out.begin(), out.begin() + std::ptrdiff_t(count), farther);
+                    if (count == out.size())
+                        max_dist_sq = out.front().dist_sq;
+                }
+                else if (d < out.front().dist_sq)
+                {
+                    std::pop_heap(out.begin(), out.end(), farther);
+                    out.back() = {i, d};
+                    std::push_heap(out.begin(), out.end(), farther);
+                    max_dist_sq = out.front().dist_sq;
+                }
+            });
+
+            std::sort_heap(out.begin(), out.begin() + std::ptrdiff_t(count), farther);
+            for (std::size_t i = 0; i < count; i++)
+                out[i].index = point_indices[out[i].index];
+            return count;
+        }
+
+        // Calls `func(index, dist_sq)` for every point with the squared distance at most `max_dist_sq`, in no particular order.
+        constexpr void for_each_within(const vec<T, N> &point, T max_dist_sq, auto &&func) const
+        {
+            Search(point, max_dist_sq, [&](std::uint32_t i, T d){func(point_indices[i], d);});
+        }
+
+        // Runs `find_nearest()` for many queries in parallel, with `k` neighbors per query.
+        // The results for `queries[i]` are written to `out[i * k, i * k + k)`, and their number to `out_counts[i]`.
+        constexpr void find_nearest_batch(std::span<const vec<T, N>> queries, std::size_t k, std::span<neighbor> out, std::span<std::uint32_t> out_counts, T max_dist_sq = std::numeric_limits<T>::infinity(), int num_threads = 0) const
+        {
+            if ((k > 0 && out.size() / k < queries.size()) || out_counts.size() < queries.size())
+                throw std::length_error("The output spans are too small for this many queries.");
+
+            parallel_for(queries.size(), num_threads, min_queries_per_thread, [&](int, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; i++)
+                    out_counts[i] = std::uint32_t(find_nearest(queries[i], out.subspan(i * k, k), max_dist_sq));
+            });
+        }
+    };
+
+    inline namespace Common
+    {
+        using Math::kd_tree;
+        using Math::kd_tree_neighbor;
+    }
+}
@@ -0,0 +1,324 @@
+#pragma once
+
+#include "em/macros/portable/tiny_func.h"
+#include "em/math/functions.h"
+#include "em/math/namespaces.h"
+#include "em/math/scalar.h"
+#include "em/math/vector.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+
+// Gradient noise: Perlin noise and simplex noise in 2D, 3D and 4D, fractal sums of those, and batched evaluation over spans and grids.
+//
+// Unlike the classic implementations, the lattice points are hashed instead of looked up in a permutation table.
+// This gives arbitrary seeds and no period, and also avoids table lookups that would prevent vectorization across samples.
+// All functions here are `constexpr`, and give the same results on all platforms (up to floating-point contraction).
+
+namespace em::Math
+{
+    namespace detail::Noise
+    {
+        // Hashes a lattice point.
+        template <int N>
+        [[nodiscard]] EM_TINY constexpr std::uint32_t Hash(const vec<int, N> &cell, std::uint32_t seed) noexcept
+        {
+            constexpr std::uint32_t factors[4] = {0x8da6b343, 0xd8163841, 0xcb1ab31f, 0x165667b1};
+            std::uint32_t h = seed;
+            for (int i = 0; i < N; i++)
+                h ^= std::uint32_t(cell[i]) * factors[i];
+            // The "lowbias32" finalizer.
+            h ^= h >> 16;
+            h *= 0x7feb352d;
+            h ^= h >> 15;
+            h *= 0x846ca68b;
+            h ^= h >> 16;
+            return h;
+        }
+
+        // The gradients for each dimension. The sizes are powers of two, to select them with a bit mask.
+        template <int N>
+        struct Gradients {};
+        template <>
+        struct Gradients<2>
+        {
+            // 4 diagonals and 4 axes.
+            static constexpr std::array<vec2<signed char>, 8> list = {{
+                {1, 1}, {-1, 1}, {1, -1}, {-1, -1},
+                {1, 0}, {-1, 0}, {0, 1}, {0, -1},
+            }};
+        };
+        template <>
+        struct Gradients<3>
+        {
+            // The 12 edges of a cube, with 4 of them repeated, as in the improved Perlin noise.
+            static constexpr std::array<vec3<signed char>, 16> list = {{
+                {1, 1, 0}, {-1, 1, 0}, {1, -1, 0}, {-1, -1, 0},
+                {1, 0, 1}, {-1, 0, 1}, {1, 0, -1}, {-1, 0, -1},
+                {0, 1, 1}, {0, -1, 1}, {0, 1, -1}, {0, -1, -1},
+                {1, 1, 0}, {-1, 1, 0}, {0, -1, 1}, {0, -1, -1},
+            }};
+        };
+        template <>
+        struct Gradients<4>
+        {
+            // The 32 edges of a tesseract: one component is zero, the rest are `+-1`.
+            static constexpr std::array<vec4<signed char>, 32> list = []{
+                std::array<vec4<signed char>, 32> ret{};
+                for (int h = 0; h < 32; h++)
+                {
+                    int bit = 0;
+                    for (int i = 0; i < 4; i++)
+                    {
+                        if (i != h >> 3)
+                            ret[std::size_t(h)][i] = (signed char)((h >> bit++ & 1) ? -1 : 1);
+                    }
+                }
+                return ret;
+            }();
+        };
+
+        // The dot product of a pseudo-random gradient with `d`.
+        template <typename T, int N>
+        [[nodiscard]] EM_TINY constexpr T GradDot(std::uint32_t hash, const vec<T, N> &d) noexcept
+        {
+            const auto &g = Gradients<N>::list[hash & (Gradients<N>::list.size() - 1)];
+            T ret = 0;
+            for (int i = 0; i < N; i++)
+                ret += T(g[i]) * d[i];
+            return ret;
+        }
+
+        // Perlin's `6t^5 - 15t^4 + 10t^3`.
+        template <typename T>
+        [[nodiscard]] EM_TINY constexpr T Fade(T t) noexcept
+        {
+            return t * t * t * fma(t, fma(t, T(6), T(-15)), T(10));
+        }
+
+        // Brings the Perlin noise to roughly `[-1, 1]`. Those were measured empirically.
+        template <int N> constexpr double perlin_scale = N == 4 ? 0.87 : 1;
+
+        // The constants for the simplex noise.
+        template <int N> struct SimplexConsts {};
+        // `f` is the skew factor `(sqrt(N+1)-1)/N`, `g` is the unskew factor `(1-1/sqrt(N+1))/N`,
+        //   `radius_sq` is the squared radius of the kernel, and `scale` brings the result to roughly `[-1, 1]`.
+        template <> struct SimplexConsts<2> {static constexpr double f = 0.36602540378443865, g = 0.21132486540518713, radius_sq = 0.5, scale = 70;};
+        template <> struct SimplexConsts<3> {static constexpr double f = 1 / 3., g = 1 / 6., radius_sq = 0.6, scale = 32;};
+        template <> struct SimplexConsts<4> {static constexpr double f = 0.30901699437494745, g = 0.13819660112501053, radius_sq = 0.6, scale = 27;};
+    }
+
+    // Perlin gradient noise. Returns values roughly in `[-1, 1]`, which are exactly zero at the integer points.
+    // Different `seed`s give unrelated patterns.
+    struct FnPerlinNoise
+    {
+        template <floating_point_scalar T, int N>
+        [[nodiscard]] static constexpr T operator()(const vec<T, N> &p, std::uint32_t seed = 0) noexcept
+        {
+            const vec<int, N> cell = ifloor(p);
+            const vec<T, N> frac = p - vec<T, N>(cell);
+
+            // The contributions of the `2^N` corners of the cell. The bit `i` of the index is the offset along the axis `i`.
+            std::array<T, 1 << N> values{};
+            for (int k = 0; k < 1 << N; k++)
+            {
+                vec<int, N> corner = cell;
+                vec<T, N> d = frac;
+                for (int i = 0; i < N; i++)
+                {
+                    if (k >> i & 1)
+                    {
+                        corner[i]++;
+                        d[i] -= 1;
+                    }
+                }
+                values[std::size_t(k)] = detail::Noise::GradDot(detail::Noise::Hash(corner, seed), d);
+            }
+
+            // Interpolate along one axis at a time, halving the number of values each time.
+            for (int i = 0; i < N; i++)
+            {
+                const T t = detail::Noise::Fade(frac[i]);
+                for (std::size_t k = 0; k < std::size_t(1) << (N - 1 - i); k++)
+                    values[k] = fma(t, values[k * 2 + 1] - values[k * 2], values[k * 2]);
+            }
+
+            return values[0] * T(detail::Noise::perlin_scale<N>);
+        }
+    };
+    inline constexpr FnPerlinNoise perlin_noise;
+
+    // Simplex noise. Returns values roughly in `[-1, 1]`. Cheaper than Perlin noise in higher dimensions, and has fewer directional artifacts.
+    // Different `seed`s give unrelated patterns.
+    struct FnSimplexNoise
+    {
+        template <floating_point_scalar T, int N>
+        [[nodiscard]] static constexpr T operator()(const vec<T, N> &p, std::uint32_t seed = 0) noexcept
+        {
+            using C = detail::Noise::SimplexConsts<N>;
+            const T g = T(C::g);
+
+            // Skew the input to find the cell, then unskew the cell origin back.
+            const vec<int, N> cell = ifloor(p + p.sum() * T(C::f));
+            const vec<T, N> d0 = p - (vec<T, N>(cell) - T(cell.sum()) * g);
+
+            // Rank the components of `d0` to find which simplex of the cell we're in.
+            // The `k`-th vertex is offset by one along the `k` axes with the largest components.
+            vec<int, N> rank{};
+            for (int i = 0; i < N; i++)
+            {
+                for (int j = i + 1; j < N; j++)
+                {
+                    if (d0[i] > d0[j])
+                        rank[i]++;
+                    else
+                        rank[j]++;
+                }
+            }
+
+            T ret = 0;
+            for (int k = 0; k <= N; k++)
+            {
+                vec<int, N> corner = cell;
+                vec<T, N> d = d0 + T(k) * g;
+                for (int i = 0; i < N; i++)
+                {
+                    if (rank[i] >= N - k)
+                    {
+                        corner[i]++;
+                        d[i] -= 1;
+                    }
+                }
+
+                T t = T(C::radius_sq) - d.x * d.x - d.y * d.y;
+                if constexpr (N >= 3)
+                    t -= d.z * d.z;
+                if constexpr (N >= 4)
+                    t -= d.w * d.w;
+                if (t > 0)
+                {
+                    t *= t;
+                    ret += t * t * detail::Noise::GradDot(detail::Noise::Hash(corner, seed), d);
+                }
+            }
+
+            return ret * T(C::scale);
+        }
+    };
+    inline constexpr FnSimplexNoise simplex_noise;
+
+
+    // The parameters for `fbm_noise()`.
+    template <floating_point_scalar T>
+    struct fbm_params
+    {
+        // The number of octaves to sum.
+        int octaves = 6;
+        // The frequency of the first octave.
+        T frequency = 1;
+        // The frequency multiplier for each next octave.
+        T lacunarity = 2;
+        // The amplitude multiplier for each next octave.
+        T gain = T(0.5);
+    };
+
+    // Fractional Brownian motion: sums several octaves of `noise` (`perlin_noise` or `simplex_noise`, or anything with the same signature),
+    //   with increasing frequencies and decreasing amplitudes.
+    // The result is divided by the sum of the amplitudes, to keep it in the same range as the underlying noise.
+    // Each octave uses a different seed, to avoid artifacts at the origin.
+    struct FnFbmNoise
+    {
+        template <typename F, floating_point_scalar T, int N>
+        [[nodiscard]] static constexpr T operator()(F &&noise, const vec<T, N> &p, const fbm_params<T> &params = {}, std::uint32_t seed = 0)
+        {
+            T ret = 0;
+            T amplitude = 1;
+            T amplitude_sum = 0;
+            vec<T, N> q = p * params.frequency;
+            for (int i = 0; i < params.octaves; i++)
+            {
+                ret += noise(q, seed + std::uint32_t(i)) * amplitude;
+                amplitude_sum += amplitude;
+                amplitude *= params.gain;
+                q *= params.lacunarity;
+            }
+            return amplitude_sum > 0 ? ret / amplitude_sum : 0;
+        }
+    };
+    inline constexpr FnFbmNoise fbm_noise;
+
+
+    // Batch evaluation:
+
+    // Evaluates `out[i] = func(points[i])`. `func` is typically `perlin_noise` or `simplex_noise`, or a lambda calling `fbm_noise()`.
+    template <typename F, floating_point_scalar T, int N>
+    constexpr void eval_noise(F &&func, std::span<const vec<T, N>> points, std::span<T> out)
+    {
+        if (out.size() < points.size())
+            throw std::length_error("The output span is smaller than the input span.");
+
+        for (std::size_t i = 0; i < points.size(); i++)
+            out[i] = func(points[i]);
+    }
+
+    // Evaluates `func` on a regular grid of `size` points: `out[x + size.x * (y + size.y * ...)] = func(origin + step * vec(x, y, ...))`.
+    // The innermost loop is along X, with all other coordinates fixed, so the compiler can vectorize it.
+    template <typename F, floating_point_scalar T, int N>
+    constexpr void eval_noise_grid(F &&func, const vec<T, N> &origin, const vec<T, N> &step, const vec<int, N> &size, std::span<T> out)
+    {
+        bool empty = false;
+        for (int i = 0; i < N; i++)
+        {
+            if (size[i] < 0)
+                throw std::length_error("The grid size can't be negative.");
+            if (size[i] == 0)
+                empty = true;
+        }
+        if (empty)
+            return;
+
+        // The number of points. Computed in `std::size_t`, since it can easily overflow `int`.
+        std::size_t num_points = 1;
+        for (int i = 0; i < N; i++)
+        {
+            if (num_points > std::numeric_limits<std::size_t>::max() / std::size_t(size[i]))
+                throw std::length_error("The number of points in the grid doesn't fit into `std::size_t`.");
+            num_points *= std::size_t(size[i]);
+        }
+        if (out.size() < num_points)
+            throw std::length_error("The output span is smaller than the grid.");
+
+        // The current position in all dimensions except X.
+        vec<int, N> pos{};
+        T *row = out.data();
+        while (true)
+        {
+            vec<T, N> p = fma(step, vec<T, N>(pos), origin);
+            for (int x = 0; x < size.x; x++)
+            {
+                p.x = fma(step.x, T(x), origin.x);
+                row[x] = func(p);
+            }
+            row += size.x;
+
+            // Advance to the next row.
+            int i = 1;
+            while (i < N && ++pos[i] == size[i])
+                pos[i++] = 0;
+            if (i == N)
+                break;
+        }
+    }
+
+    inline namespace Common
+    {
+        using Math::perlin_noise;
+        using Math::simplex_noise;
+        using Math::fbm_noise;
+        using Math::fbm_params;
+    }
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "em/math/namespaces.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <span>
+#include <thread>
+#include <vector>
+
+// A minimal fork-join helper for the batch algorithms: splits an index range into contiguous chunks and runs each one on its own thread.
+
+namespace em::Math
+{
+    // Returns how many chunks to split `count` elements into, so that each chunk has at least `min_chunk_size` elements.
+    // `num_threads <= 0` means `std::thread::hardware_concurrency()`. Returns 1 for small inputs without touching the threads at all,
+    //   so the callers stay usable in constant evaluation.
+    [[nodiscard]] constexpr int parallel_chunk_count(std::size_t count, int num_threads = 0, std::size_t min_chunk_size = 1)
+    {
+        if (num_threads == 1 || count <= min_chunk_size)
+            return 1;
+        if (num_threads <= 0)
+            num_threads = std::max(1, int(std::thread::hardware_concurrency()));
+        return int(std::clamp(count / std::max(min_chunk_size, std::size_t(1)), std::size_t(1), std::size_t(num_threads)));
+    }
+
+    // The first element of the chunk `i` out of `num_chunks`. The chunk `i` is `[parallel_chunk_begin(i), parallel_chunk_begin(i + 1))`.
+    [[nodiscard]] constexpr std::size_t parallel_chunk_begin(std::size_t count, int num_chunks, int i)
+    {
+        return count / std::size_t(num_chunks) * std::size_t(i) + count % std::size_t(num_chunks) * std::size_t(i) / std::size_t(num_chunks);
+    }
+
+    namespace detail::Parallel
+    {
+        // The multithreaded part of `parallel_for_chunks()`. This is a separate function, because threads can't be used in `constexpr` functions.
+        void RunChunksOnThreads(std::size_t count, int num_chunks, auto &&func)
+        {
+            std::vector<std::exception_ptr> errors(std::size_t(num_chunks), nullptr);
+            auto run = [&](int i) noexcept
+            {
+                try
+                {
+                    func(i, parallel_chunk_begin(count, num_chunks, i), parallel_chunk_begin(count, num_chunks, i + 1));
+                }
+                catch (...)
+                {
+                    errors[std::size_t(i)] = std::current_exception();
+                }
+            };
+
+            {
+                std::vector<std::jthread> threads;
+                threads.reserve(std::size_t(num_chunks - 1));
+                for (int i = 1; i < num_chunks; i++)
+                    threads.emplace_back(run, i);
+                run(0);
+            } // Join the threads.
+
+            for (const std::exception_ptr &e : errors)
+            {
+                if (e)
+                    std::rethrow_exception(e);
+            }
+        }
+    }
+
+    // Splits `[0, count)` into `num_chunks` nearly equal contiguous parts, and calls `func(chunk_index, begin, end)` for each of them.
+    // Each chunk runs on its own thread, the first one runs on the calling thread. Returns when all of them finish.
+    // All chunks run concurrently, so they're allowed to wait for each other (e.g. using `std::barrier`), as long as nothing throws in between.
+    // If some calls throw, the exception from the smallest chunk index is rethrown after all threads finish.
+    constexpr void parallel_for_chunks(std::size_t count, int num_chunks, auto &&func)
+    {
+        if (num_chunks <= 1)
+        {
+            func(0, std::size_t(0), count);
+            return;
+        }
+
+        detail::Parallel::RunChunksOnThreads(count, num_chunks, func);
+    }
+
+    // Same as `parallel_for_chunks()`, but picks the number of chunks automatically using `parallel_chunk_count()`.
+    constexpr void parallel_for(std::size_t count, int num_threads, std::size_t min_chunk_size, auto &&func)
+    {
+        parallel_for_chunks(count, parallel_chunk_count(count, num_threads, min_chunk_size), func);
+    }
+
+    namespace detail::Parallel
+    {
+        // A subtree that a tree builder postponed, to be built in parallel with others by `BuildSubtrees()`.
+        // It's built from `[begin, end)` of the tree's index array, into the placeholder node `node_index`.
+        struct SubtreeTask
+        {
+            std::uint32_t node_index = 0;
+            std::size_t begin = 0;
+            std::size_t end = 0;
+            // The depth of `node_index`, for the trees that care about it.
+            int depth = 0;
+        };
+
+        // Builds the postponed subtrees in parallel, then splices them into `nodes`.
+        // `build(task, subtree)` is called with `subtree` holding one default node, and must build the subtree into it, appending the children.
+        // The tasks run concurrently, so they must not interfere (which they don't if they work on disjoint index ranges).
+        // The subtree roots replace the placeholder nodes, the rest goes to the end. The nodes must have `first` (the left child,
+        //   for non-leaves) and `is_leaf()`, and the children must come after their parents.
+        template <typename Node>
+        constexpr void BuildSubtrees(std::vector<Node> &nodes, std::span<const SubtreeTask> tasks, int num_chunks, auto &&build)
+        {
+            std::vector<std::vector<Node>> subtrees(tasks.size());
+            parallel_for_chunks(tasks.size(), std::min(num_chunks, int(tasks.size())), [&](int, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; i++)
+                {
+                    subtrees[i].resize(1);
+                    build(tasks[i], subtrees[i]);
+                }
+            });
+
+            for (std::size_t i = 0; i < tasks.size(); i++)
+            {
+                const std::uint32_t offset = std::uint32_t(nodes.size()) - 1;
+                for (std::size_t j = 0; j < subtrees[i].size(); j++)
+                {
+                    Node n = subtrees[i][j];
+                    if (!n.is_leaf())
+                        n.first += offset;
+                    if (j == 0)
+                        nodes[tasks[i].node_index] = n;
+                    else
+                        nodes.push_back(n);
+                }
+            }
+        }
+    }
+
+    inline namespace Common
+    {
+        using Math::parallel_for;
+        using Math::parallel_for_chunks;
+    }
+}
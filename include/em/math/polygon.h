@@ -0,0 +1,207 @@
+#pragma once
+
+#include "em/math/namespaces.h"
+#include "em/math/parallel.h"
+#include "em/math/robust_predicates.h"
+#include "em/math/vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// 2D polygons given as spans of vertices: convex hulls, areas, centroids and point-in-polygon tests.
+// Nothing here allocates, the results are written to the spans you provide.
+
+namespace em::Math
+{
+    // The polygons are closed implicitly (the last vertex connects to the first one), and can be self-intersecting unless stated otherwise.
+    // All orientation tests use `Robust::orient2d()`, so they're exact for both integers and floating-point numbers.
+    template <Robust::predicate_scalar T>
+    struct polygon_2d
+    {
+        using point_type = vec2<T>;
+        // The type of areas and centroids. Integers use `double`.
+        using real_type = std::conditional_t<std::is_floating_point_v<T>, T, double>;
+
+        // Inputs with less than this many points per thread use fewer threads.
+        static constexpr std::size_t min_points_per_thread = 1 << 14;
+
+        // The order in which `convex_hull()` sorts the points: by X, then by Y.
+        [[nodiscard]] static constexpr bool less(const point_type &a, const point_type &b)
+        {
+            return a.x < b.x || (a.x == b.x && a.y < b.y);
+        }
+
+        // Sorts the points with `less()`, using `scratch` (at least as large as `points`) as a temporary buffer.
+        // Each thread sorts its own chunk, and then the chunks are merged in pairs, also in parallel.
+        static constexpr void sort_points(std::span<point_type> points, std::span<point_type> scratch, int num_threads = 0)
+        {
+            const std::size_t n = points.size();
+            if (scratch.size() < n)
+                throw std::length_error("The scratch buffer for sorting points is too small.");
+
+            const int num_chunks = parallel_chunk_count(n, num_threads, min_points_per_thread);
+            parallel_for_chunks(n, num_chunks, [&](int, std::size_t begin, std::size_t end)
+            {
+                std::sort(points.begin() + std::ptrdiff_t(begin), points.begin() + std::ptrdiff_t(end), less);
+            });
+
+            std::span<point_type> source = points;
+            std::span<point_type> target = scratch.first(n);
+            for (int width = 1; width < num_chunks; width *= 2)
+            {
+                const int num_pairs = (num_chunks + width * 2 - 1) / (width * 2);
+                parallel_for_chunks(std::size_t(num_pairs), num_pairs, [&](int pair, std::size_t, std::size_t)
+                {
+                    const std::size_t begin = parallel_chunk_begin(n, num_chunks, pair * width * 2);
+                    const std::size_t mid = parallel_chunk_begin(n, num_chunks, std::min(pair * width * 2 + width, num_chunks));
+                    const std::size_t end = parallel_chunk_begin(n, num_chunks, std::min(pair * width * 2 + width * 2, num_chunks));
+                    std::merge(
+                        source.begin() + std::ptrdiff_t(begin), source.begin() + std::ptrdiff_t(mid),
+                        source.begin() + std::ptrdiff_t(mid), source.begin() + std::ptrdiff_t(end),
+                        target.begin() + std::ptrdiff_t(begin), less
+                    );
+                });
+                std::swap(source, target);
+            }
+
+            if (source.data() != points.data())
+                std::copy(source.begin(), source.end(), points.begin());
+        }
+
+        // Computes the convex hull with Andrew's monotone chain algorithm. `points` are sorted in place with `sort_points()`.
+        // `out` must have room for `points.size() + 1` points, it's also used as the scratch buffer for sorting.
+        // Returns the part of `out` with the hull, counterclockwise (assuming Y points up), starting from the leftmost bottom point.
+        //   The points lying on the edges are omitted. A single point is returned if all points are the same, and none if there are no points.
+        static constexpr std::span<point_type> convex_hull(std::span<point_type> points, std::span<point_type> out, int num_threads = 0)
+        {
+            const std::size_t n = points.size();
+            if (out.size() < n + 1)
+                throw std::length_error("The output buffer for a convex hull needs room for one more point than the input.");
+            if (n == 0)
+                return out.first(0);
+
+            sort_points(points, out, num_threads);
+
+            if (points.front() == points.back())
+            {
+                out[0] = points[0];
+                return out.first(1);
+            }
+
+            // The lower half, then the upper half. When adding the upper half, the stack never has more than one point that's also in the lower half,
+            //   so `n + 1` points are always enough.
+            std::size_t k = 0;
+            for (std::size_t i = 0; i < n; i++)
+            {
+                while (k >= 2 && Robust::orient2d(out[k - 2], out[k - 1], points[i]) <= 0)
+                    k--;
+                out[k++] = points[i];
+            }
+            const std::size_t lower_end = k + 1;
+            for (std::size_t i = n - 1; i-- > 0;)
+            {
+                while (k >= lower_end && Robust::orient2d(out[k - 2], out[k - 1], points[i]) <= 0)
+                    k--;
+                out[k++] = points[i];
+            }
+
+            // The first point is repeated at the end.
+            return out.first(k - 1);
+        }
+
+        // The area, positive if the polygon is counterclockwise. Self-intersecting polygons give the sum of the areas of the parts, with their signs.
+        [[nodiscard]] static constexpr real_type signed_area(std::span<const point_type> polygon)
+        {
+            if (polygon.size() < 3)
+                return 0;
+
+            // Relative to the first vertex, to reduce the rounding errors far from the origin.
+            const vec2<real_type> origin(polygon[0]);
+            real_type sum = 0;
+            for (std::size_t i = 1; i + 1 < polygon.size(); i++)
+            {
+                const vec2<real_type> a = vec2<real_type>(polygon[i]) - origin;
+                const vec2<real_type> b = vec2<real_type>(polygon[i + 1]) - origin;
+                sum += a.x * b.y - a.y * b.x;
+            }
+            return sum / 2;
+        }
+
+        // `1` if the polygon is counterclockwise, `-1` if clockwise, `0` if the area is zero. For self-intersecting polygons this is the sign of `signed_area()`.
+        [[nodiscard]] static constexpr int orientation(std::span<const point_type> polygon)
+        {
+            const real_type area = signed_area(polygon);
+            return (area > 0) - (area < 0);
+        }
+
+        // The center of mass of the polygon, assuming it's not self-intersecting. Returns NaNs if the area is zero.
+        [[nodiscard]] static constexpr vec2<real_type> centroid(std::span<const point_type> polygon)
+        {
+            if (polygon.empty())
+                return vec2<real_type>(std::numeric_limits<real_type>::quiet_NaN());
+
+            // Sums the centroids of the triangles fanning out from the first vertex, weighted by their areas.
+            const vec2<real_type> origin(polygon[0]);
+            vec2<real_type> sum;
+            real_type area_sum = 0;
+            for (std::size_t i = 1; i + 1 < polygon.size(); i++)
+            {
+                const vec2<real_type> a = vec2<real_type>(polygon[i]) - origin;
+                const vec2<real_type> b = vec2<real_type>(polygon[i + 1]) - origin;
+                const real_type area = a.x * b.y - a.y * b.x;
+                sum += (a + b) * area;
+                area_sum += area;
+            }
+            return origin + sum / (area_sum * 3);
+        }
+
+        // How many times the polygon goes counterclockwise around the point. Non-zero means the point is inside (with the non-zero fill rule).
+        // This is exact for points not on the boundary. The points on the boundary can count as either inside or outside.
+        [[nodiscard]] static constexpr int winding_number(std::span<const point_type> polygon, const point_type &point)
+        {
+            int ret = 0;
+            for (std::size_t i = 0; i < polygon.size(); i++)
+            {
+                const point_type &a = polygon[i];
+                const point_type &b = polygon[i + 1 == polygon.size() ? 0 : i + 1];
+                if (a.y <= point.y)
+                {
+                    if (b.y > point.y && Robust::orient2d(a, b, point) > 0)
+                        ret++;
+                }
+                else
+                {
+                    if (b.y <= point.y && Robust::orient2d(a, b, point) < 0)
+                        ret--;
+                }
+            }
+            return ret;
+        }
+
+        // Tests each of `points` against the polygon with `winding_number()`, and writes `true` to `out` for the ones inside.
+        // `num_threads == 0` means `std::thread::hardware_concurrency()`.
+        static constexpr void contains_batch(std::span<const point_type> polygon, std::span<const point_type> points, std::span<bool> out, int num_threads = 0)
+        {
+            if (out.size() < points.size())
+                throw std::length_error("The output span for point-in-polygon tests is too small.");
+
+            // The threads are worth it for either many points or a large polygon.
+            const std::size_t min_points = std::max(std::size_t(1), min_points_per_thread / std::max(std::size_t(1), polygon.size()));
+            parallel_for(points.size(), num_threads, min_points, [&](int, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; i++)
+                    out[i] = winding_number(polygon, points[i]) != 0;
+            });
+        }
+    };
+
+    inline namespace Common
+    {
+        using Math::polygon_2d;
+    }
+}
@@ -0,0 +1,245 @@
+#pragma once
+
+#include "em/math/functions.h"
+#include "em/math/larger_type.h"
+#include "em/math/namespaces.h"
+#include "em/math/parallel.h"
+#include "em/math/scalar.h"
+#include "em/math/vector.h"
+#include "em/math/vector_functions.h"
+
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+// Quaternions for 3D rotations.
+// There's no matrix type yet, so the 3x3 rotation matrices are passed around as `vec3<vec3<T>>`, holding the columns.
+
+namespace em::Math
+{
+    // A quaternion, stored as a `vec4` with `w` being the real part. The default one is the identity.
+    // The rotations assume the quaternion is normalized.
+    template <floating_point_scalar T>
+    struct quat
+    {
+        using type = T;
+
+        vec4<T> v = vec4<T>(0, 0, 0, 1);
+
+        // Inputs with less than this many elements per thread use fewer threads.
+        static constexpr std::size_t min_elements_per_thread = 1 << 14;
+
+        constexpr quat() {}
+        constexpr explicit quat(const vec4<T> &v) : v(v) {}
+        constexpr quat(T x, T y, T z, T w) : v(x, y, z, w) {}
+        constexpr quat(const vec3<T> &xyz, T w) : v(xyz.to_vec4(w)) {}
+
+        template <floating_point_scalar U> requires(!std::is_same_v<T, U>)
+        constexpr explicit(!can_safely_convert_to<U, T>) quat(const quat<U> &other) : v(other.v) {}
+
+        [[nodiscard]] friend constexpr bool operator==(const quat &, const quat &) = default;
+
+        // A rotation by `angle` radians around `axis`, counterclockwise when looking against the axis. The axis must be normalized.
+        [[nodiscard]] static quat from_axis_angle(const vec3<T> &axis, T angle)
+        {
+            return quat(axis * T(std::sin(angle / 2)), T(std::cos(angle / 2)));
+        }
+
+        // From a rotation matrix, given as columns. Picks the largest of the four components to compute first (Shepperd's method), to stay accurate near 180 degrees.
+        [[nodiscard]] static constexpr quat from_mat3(const vec3<vec3<T>> &m)
+        {
+            // `mRC` is the row `R`, column `C`.
+            const T m00 = m.x.x, m01 = m.y.x, m02 = m.z.x;
+            const T m10 = m.x.y, m11 = m.y.y, m12 = m.z.y;
+            const T m20 = m.x.z, m21 = m.y.z, m22 = m.z.z;
+
+            const T trace = m00 + m11 + m22;
+            if (trace > 0)
+            {
+                const T s = sqrt(trace + 1) * 2;
+                return quat((m21 - m12) / s, (m02 - m20) / s, (m10 - m01) / s, s / 4);
+            }
+            else if (m00 > m11 && m00 > m22)
+            {
+                const T s = sqrt(1 + m00 - m11 - m22) * 2;
+                return quat(s / 4, (m01 + m10) / s, (m02 + m20) / s, (m21 - m12) / s);
+            }
+            else if (m11 > m22)
+            {
+                const T s = sqrt(1 + m11 - m00 - m22) * 2;
+                return quat((m01 + m10) / s, s / 4, (m12 + m21) / s, (m02 - m20) / s);
+            }
+            else
+            {
+                const T s = sqrt(1 + m22 - m00 - m11) * 2;
+                return quat((m02 + m20) / s, (m12 + m21) / s, s / 4, (m10 - m01) / s);
+            }
+        }
+
+        // The imaginary part.
+        [[nodiscard]] constexpr vec3<T> xyz() const {return v.to_vec3();}
+
+        // For normalized quaternions this is the inverse, and is cheaper than `inverse()`.
+        [[nodiscard]] constexpr quat conjugate() const {return quat(-v.x, -v.y, -v.z, v.w);}
+        [[nodiscard]] constexpr quat inverse() const {return quat(conjugate().v / dot(v, v));}
+        // Returns NaNs for the zero quaternion.
+        [[nodiscard]] constexpr quat normalize() const {return quat(Math::normalize(v));}
+
+        // Rotates a vector. This is `q * v * q^-1` with the terms that cancel out removed, two cross products in total.
+        [[nodiscard]] constexpr vec3<T> rotate(const vec3<T> &p) const
+        {
+            const vec3<T> u = xyz();
+            const vec3<T> t = cross(u, p) * T(2);
+            return p + t * v.w + cross(u, t);
+        }
+
+        // Returns the rotation matrix as columns.
+        [[nodiscard]] constexpr vec3<vec3<T>> to_mat3() const
+        {
+            const T x2 = v.x * 2, y2 = v.y * 2, z2 = v.z * 2;
+            const T xx = v.x * x2, yy = v.y * y2, zz = v.z * z2;
+            const T xy = v.x * y2, xz = v.x * z2, yz = v.y * z2;
+            const T wx = v.w * x2, wy = v.w * y2, wz = v.w * z2;
+            return vec3<vec3<T>>(
+                vec3<T>(1 - yy - zz, xy + wz, xz - wy),
+                vec3<T>(xy - wz, 1 - xx - zz, yz + wx),
+                vec3<T>(xz + wy, yz - wx, 1 - xx - yy)
+            );
+        }
+
+        // Rotates all of `input` by this quaternion, writing to `output` (which can be the same span).
+        // Converts the quaternion to a matrix first, which is cheaper per vector than `rotate()`.
+        // `num_threads == 0` means `std::thread::hardware_concurrency()`.
+        constexpr void rotate_batch(std::span<const vec3<T>> input, std::span<vec3<T>> output, int num_threads = 0) const
+        {
+            if (output.size() < input.size())
+                throw std::length_error("The output span for rotating vectors is too small.");
+
+            const vec3<vec3<T>> m = to_mat3();
+            parallel_for(input.size(), num_threads, min_elements_per_thread, [&](int, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; i++)
+                {
+                    const vec3<T> p = input[i];
+                    output[i] = fma(m.x, vec3<T>(p.x), fma(m.y, vec3<T>(p.y), m.z * p.z));
+                }
+            });
+        }
+
+        // Rotates each of `input` by the respective quaternion, writing to `output` (which can be the same span).
+        static constexpr void rotate_batch(std::span<const quat> rotations, std::span<const vec3<T>> input, std::span<vec3<T>> output, int num_threads = 0)
+        {
+            if (rotations.size() != input.size())
+                throw std::length_error("The number of quaternions doesn't match the number of vectors to rotate.");
+            if (output.size() < input.size())
+                throw std::length_error("The output span for rotating vectors is too small.");
+
+            parallel_for(input.size(), num_threads, min_elements_per_thread, [&](int, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; i++)
+                    output[i] = rotations[i].rotate(input[i]);
+            });
+        }
+
+        // Applies `nlerp()` to each pair of `a` and `b`, with the same `t`, which is how animation poses are usually blended.
+        // `output` can be the same as one of the inputs.
+        static constexpr void nlerp_batch(std::span<const quat> a, std::span<const quat> b, T t, std::span<quat> output, int num_threads = 0)
+        {
+            InterpolateBatch(a, b, output, num_threads, [t](const quat &x, const quat &y){return nlerp(x, y, t);});
+        }
+        // Same, but with `slerp_fast()`.
+        static constexpr void slerp_fast_batch(std::span<const quat> a, std::span<const quat> b, T t, std::span<quat> output, int num_threads = 0)
+        {
+            InterpolateBatch(a, b, output, num_threads, [t](const quat &x, const quat &y){return slerp_fast(x, y, t);});
+        }
+
+      private:
+        static constexpr void InterpolateBatch(std::span<const quat> a, std::span<const quat> b, std::span<quat> output, int num_threads, auto &&func)
+        {
+            if (a.size() != b.size())
+                throw std::length_error("The number of quaternions to interpolate between doesn't match.");
+            if (output.size() < a.size())
+                throw std::length_error("The output span for interpolating quaternions is too small.");
+
+            parallel_for(a.size(), num_threads, min_elements_per_thread, [&](int, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; i++)
+                    output[i] = func(a[i], b[i]);
+            });
+        }
+    };
+
+    // Combines the rotations: `(a * b).rotate(p) == a.rotate(b.rotate(p))`.
+    template <typename A, typename B>
+    [[nodiscard]] constexpr quat<larger_t<A, B>> operator*(const quat<A> &a, const quat<B> &b)
+    {
+        using L = larger_t<A, B>;
+        const vec4<L> p(a.v), q(b.v);
+        return quat<L>(
+            p.w * q.x + p.x * q.w + p.y * q.z - p.z * q.y,
+            p.w * q.y - p.x * q.z + p.y * q.w + p.z * q.x,
+            p.w * q.z + p.x * q.y - p.y * q.x + p.z * q.w,
+            p.w * q.w - p.x * q.x - p.y * q.y - p.z * q.z
+        );
+    }
+
+    // Linear interpolation followed by normalization. Takes the shortest path, but the speed isn't constant: it's fastest in the middle.
+    template <typename T>
+    [[nodiscard]] constexpr quat<T> nlerp(const quat<T> &a, const quat<T> &b, std::type_identity_t<T> t)
+    {
+        const vec4<T> b_v = dot(a.v, b.v) < 0 ? -b.v : b.v;
+        return quat<T>(fma(b_v - a.v, vec4<T>(t), a.v)).normalize();
+    }
+
+    // The spherical interpolation: the shortest path with a constant speed.
+    template <typename T>
+    [[nodiscard]] quat<T> slerp(const quat<T> &a, const quat<T> &b, std::type_identity_t<T> t)
+    {
+        T d = dot(a.v, b.v);
+        vec4<T> b_v = b.v;
+        if (d < 0)
+        {
+            d = -d;
+            b_v = -b_v;
+        }
+
+        // When the angle is tiny, `sin(angle)` loses precision, and the nlerp is indistinguishable anyway.
+        if (d > T(0.9995))
+            return nlerp(a, quat<T>(b_v), t);
+
+        const T angle = T(std::acos(d));
+        const T inv_sin = 1 / T(std::sin(angle));
+        return quat<T>(a.v * (T(std::sin((1 - t) * angle)) * inv_sin) + b_v * (T(std::sin(t * angle)) * inv_sin));
+    }
+
+    // An approximation of `slerp()` without the trigonometry: `nlerp()` with `t` adjusted by a polynomial fitted to correct the speed.
+    // Stays within about 0.001 radians of `slerp()` (the plain `nlerp()` is off by up to 0.14 near 180 degrees).
+    template <typename T>
+    [[nodiscard]] constexpr quat<T> slerp_fast(const quat<T> &a, const quat<T> &b, std::type_identity_t<T> t)
+    {
+        const T d_signed = dot(a.v, b.v);
+        const T d = d_signed < 0 ? -d_signed : d_signed;
+        const T ca = fma(d, fma(d, fma(d, T(-1.43519), T(3.55645)), T(-3.2452)), T(1.0904));
+        const T cb = fma(d, fma(d, T(0.215638), T(-1.06021)), T(0.848013));
+        const T t_c = t - T(0.5);
+        const T k = fma(ca * t_c, t_c, cb);
+        return nlerp(a, b, fma(t * t_c * (t - 1), k, t));
+    }
+
+    // Implement `larger_t` logic for quaternions.
+    namespace Customize
+    {
+        template <typename A, typename B> requires have_larger_type<A, B>
+        struct LargerType<quat<A>, quat<B>> {using type = quat<larger_t<A, B>>;};
+    }
+
+    inline namespace Common
+    {
+        using Math::quat;
+        using Math::nlerp;
+        using Math::slerp;
+        using Math::slerp_fast;
+    }
+}
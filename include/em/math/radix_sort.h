@@ -0,0 +1,312 @@
+#pragma once
+
+#include "em/math/namespaces.h"
+#include "em/math/parallel.h"
+#include "em/math/scalar.h"
+
+#include <algorithm>
+#include <array>
+#include <barrier>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// A parallel LSD radix sort, for sorting large arrays (e.g. points by their Morton codes) much faster than `std::sort()`.
+
+namespace em::Math
+{
+    // The key types `radix_sorter` supports.
+    template <typename T>
+    concept radix_sort_key = (integral_scalar<T> && !std::is_same_v<T, bool>) || std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+    namespace detail::RadixSort
+    {
+        template <typename K> struct UnsignedKey {using type = std::make_unsigned_t<K>;};
+        template <> struct UnsignedKey<float> {using type = std::uint32_t;};
+        template <> struct UnsignedKey<double> {using type = std::uint64_t;};
+
+        // Maps the keys to unsigned integers with the same order.
+        template <radix_sort_key K>
+        [[nodiscard]] constexpr typename UnsignedKey<K>::type ToUnsigned(K key) noexcept
+        {
+            using U = typename UnsignedKey<K>::type;
+            constexpr U sign_bit = U(1) << (sizeof(U) * 8 - 1);
+            if constexpr (std::is_floating_point_v<K>)
+            {
+                // Flip all bits of negative numbers, and only the sign bit of positive numbers.
+                U bits = std::bit_cast<U>(key);
+                return bits & sign_bit ? U(~bits) : U(bits | sign_bit);
+            }
+            else if constexpr (std::is_signed_v<K>)
+            {
+                return U(U(key) ^ sign_bit);
+            }
+            else
+            {
+                return key;
+            }
+        }
+
+        // The inverse of `ToUnsigned()`.
+        template <radix_sort_key K>
+        [[nodiscard]] constexpr K FromUnsigned(typename UnsignedKey<K>::type bits) noexcept
+        {
+            using U = typename UnsignedKey<K>::type;
+            constexpr U sign_bit = U(1) << (sizeof(U) * 8 - 1);
+            if constexpr (std::is_floating_point_v<K>)
+                return std::bit_cast<K>(bits & sign_bit ? U(bits ^ sign_bit) : U(~bits));
+            else if constexpr (std::is_signed_v<K>)
+                return K(U(bits ^ sign_bit));
+            else
+                return bits;
+        }
+    }
+
+    // A stable LSD radix sort with 8-bit digits, which holds on to its scratch memory, so sorting repeatedly doesn't allocate.
+    // Reuse the same object for all sorts with the same key type.
+    //
+    // Floating-point keys are ordered as `-inf < ... < -0 < +0 < ... < +inf`, and NaNs go to the ends, depending on their sign bit.
+    // Passes where all keys have the same digit are skipped, so e.g. small integer keys are sorted faster.
+    //
+    // Every function accepts `num_threads`, where `0` means `std::thread::hardware_concurrency()`.
+    // Small inputs are always sorted on the calling thread. All functions are `constexpr` when running on one thread.
+    // The number of elements is limited to `2^32 - 1`.
+    template <radix_sort_key K>
+    class radix_sorter
+    {
+      public:
+        using key_type = K;
+
+        // Arrays with less than this many elements per thread use fewer threads.
+        static constexpr std::size_t min_elements_per_thread = 1 << 16;
+
+      private:
+        using U = typename detail::RadixSort::UnsignedKey<K>::type;
+
+        static constexpr int num_passes = sizeof(U);
+        static constexpr int num_buckets = 256;
+
+        // The keys and the original element indices, ping-ponged between the passes.
+        std::array<std::vector<U>, 2> keys;
+        std::array<std::vector<std::uint32_t>, 2> indices;
+        // `num_buckets` counters per chunk.
+        std::vector<std::size_t> histograms;
+        // Which of the two buffers has the sorted data.
+        int sorted_buffer = 0;
+
+        // Runs the passes on one chunk. `sync()` is called when all chunks must wait for each other.
+        constexpr int RunPasses(int chunk, int num_chunks, std::size_t begin, std::size_t end, auto &&sync) noexcept
+        {
+            const std::size_t n = keys[0].size();
+            std::size_t *hist = histograms.data() + std::size_t(chunk) * num_buckets;
+
+            int cur = 0;
+            for (int pass = 0; pass < num_passes; pass++)
+            {
+                const int shift = pass * 8;
+
+                std::fill_n(hist, num_buckets, std::size_t(0));
+                for (std::size_t i = begin; i < end; i++)
+                    hist[keys[cur][i] >> shift & 0xff]++;
+
+                sync();
+
+                // Where this chunk writes each digit: after all smaller digits, and after this digit in the preceding chunks.
+                // Every chunk computes the same totals, so they all agree on skipping the pass.
+                std::array<std::size_t, num_buckets> offsets{};
+                bool skip_pass = false;
+                std::size_t total = 0;
+                for (int d = 0; d < num_buckets; d++)
+                {
+                    std::size_t digit_total = 0;
+                    for (int c = 0; c < num_chunks; c++)
+                    {
+                        const std::size_t count = histograms[std::size_t(c) * num_buckets + std::size_t(d)];
+                        if (c == chunk)
+                            offsets[std::size_t(d)] = total + digit_total;
+                        digit_total += count;
+                    }
+                    if (digit_total == n)
+                        skip_pass = true;
+                    total += digit_total;
+                }
+
+                if (!skip_pass)
+                {
+                    const int next = cur ^ 1;
+                    for (std::size_t i = begin; i < end; i++)
+                    {
+                        const std::size_t j = offsets[keys[cur][i] >> shift & 0xff]++;
+                        keys[next][j] = keys[cur][i];
+                        indices[next][j] = indices[cur][i];
+                    }
+                    cur = next;
+                }
+
+                // The next pass reads what other chunks wrote, and overwrites the histograms.
+                sync();
+            }
+            return cur;
+        }
+
+        // Fills the keys using `get_key(i)` and sorts them, remembering the original indices.
+        constexpr void SortKeys(std::size_t n, int num_threads, auto &&get_key)
+        {
+            if (n > std::numeric_limits<std::uint32_t>::max())
+                throw std::length_error("Too many elements for the radix sort.");
+
+            const int num_chunks = parallel_chunk_count(n, num_threads, min_elements_per_thread);
+
+            for (int i = 0; i < 2; i++)
+            {
+                keys[std::size_t(i)].resize(n);
+                indices[std::size_t(i)].resize(n);
+            }
+            histograms.resize(std::size_t(num_chunks) * num_buckets);
+
+            parallel_for_chunks(n, num_chunks, [&](int, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; i++)
+                {
+                    keys[0][i] = detail::RadixSort::ToUnsigned(K(get_key(i)));
+                    indices[0][i] = std::uint32_t(i);
+                }
+            });
+
+            if (num_chunks == 1)
+            {
+                sorted_buffer = RunPasses(0, 1, 0, n, []{});
+            }
+            else
+            {
+                RunPassesParallel(num_chunks);
+            }
+        }
+
+        // Runs the passes on several threads. This is a separate function, because `std::barrier` can't be used in `constexpr` functions.
+        void RunPassesParallel(int num_chunks)
+        {
+            std::barrier sync_point(num_chunks);
+            parallel_for_chunks(keys[0].size(), num_chunks, [&](int chunk, std::size_t begin, std::size_t end)
+            {
+                int result = RunPasses(chunk, num_chunks, begin, end, [&]{sync_point.arrive_and_wait();});
+                if (chunk == 0)
+                    sorted_buffer = result;
+            });
+        }
+
+        // Reorders `elems` in place, so that `elems[i]` becomes the old `elems[perm[i]]`. Destroys `perm`.
+        template <typename T>
+        static constexpr void PermuteInPlace(std::span<T> elems, std::span<std::uint32_t> perm)
+        {
+            // Follow the cycles, marking the visited elements with `perm[i] == i`.
+            for (std::size_t i = 0; i < elems.size(); i++)
+            {
+                if (perm[i] == i)
+                    continue;
+                T tmp = std::move(elems[i]);
+                std::size_t j = i;
+                while (true)
+                {
+                    std::size_t k = perm[j];
+                    perm[j] = std::uint32_t(j);
+                    if (k == i)
+                    {
+                        elems[j] = std::move(tmp);
+                        break;
+                    }
+                    elems[j] = std::move(elems[k]);
+                    j = k;
+                }
+            }
+        }
+
+      public:
+        constexpr radix_sorter() {}
+
+        // Preallocates the scratch memory for this many elements.
+        constexpr void reserve(std::size_t n)
+        {
+            for (int i = 0; i < 2; i++)
+            {
+                keys[std::size_t(i)].reserve(n);
+                indices[std::size_t(i)].reserve(n);
+            }
+        }
+
+        // Frees the scratch memory.
+        constexpr void release()
+        {
+            keys = {};
+            indices = {};
+            histograms = {};
+        }
+
+        // Writes the permutation that sorts `keys`: `out_perm[i]` is the index of the `i`-th smallest key.
+        // Use this to sort several arrays (e.g. structure-of-arrays) by the same keys.
+        constexpr void sort_permutation(std::span<const K> in_keys, std::span<std::uint32_t> out_perm, int num_threads = 0)
+        {
+            if (out_perm.size() < in_keys.size())
+                throw std::length_error("The output span is smaller than the input span.");
+
+            SortKeys(in_keys.size(), num_threads, [&](std::size_t i){return in_keys[i];});
+            std::copy(indices[std::size_t(sorted_buffer)].begin(), indices[std::size_t(sorted_buffer)].end(), out_perm.begin());
+        }
+
+        // Sorts `in_keys` in place, and reorders `values` the same way. The spans must have the same size.
+        template <typename V>
+        constexpr void sort_pairs(std::span<K> in_keys, std::span<V> values, int num_threads = 0)
+        {
+            if (values.size() != in_keys.size())
+                throw std::length_error("The key and value spans have different sizes.");
+
+            SortKeys(in_keys.size(), num_threads, [&](std::size_t i){return in_keys[i];});
+
+            const std::vector<U> &sorted_keys = keys[std::size_t(sorted_buffer)];
+            parallel_for(in_keys.size(), num_threads, min_elements_per_thread, [&](int, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; i++)
+                    in_keys[i] = detail::RadixSort::FromUnsigned<K>(sorted_keys[i]);
+            });
+            PermuteInPlace(values, std::span(indices[std::size_t(sorted_buffer)]));
+        }
+
+        // Writes the elements of `in` into `out`, sorted by `key_func(elem)`, which must return something convertible to `K`.
+        // `key_func` is called exactly once per element, and can run on several threads at once.
+        // This is faster than the in-place version below, because the elements are copied in parallel.
+        template <typename T, typename F>
+        constexpr void sort_by_key(std::span<const T> in, std::span<T> out, F &&key_func, int num_threads = 0)
+        {
+            if (out.size() < in.size())
+                throw std::length_error("The output span is smaller than the input span.");
+
+            SortKeys(in.size(), num_threads, [&](std::size_t i){return key_func(in[i]);});
+
+            const std::vector<std::uint32_t> &perm = indices[std::size_t(sorted_buffer)];
+            parallel_for(in.size(), num_threads, min_elements_per_thread, [&](int, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; i++)
+                    out[i] = in[perm[i]];
+            });
+        }
+
+        // Sorts `elems` in place by `key_func(elem)`. See the function above.
+        template <typename T, typename F>
+        constexpr void sort_by_key(std::span<T> elems, F &&key_func, int num_threads = 0)
+        {
+            SortKeys(elems.size(), num_threads, [&](std::size_t i){return key_func(std::as_const(elems[i]));});
+            PermuteInPlace(elems, std::span(indices[std::size_t(sorted_buffer)]));
+        }
+    };
+
+    inline namespace Common
+    {
+        using Math::radix_sorter;
+    }
+}
@@ -0,0 +1,330 @@
+#pragma once
+
+#include "em/macros/portable/tiny_func.h"
+#include "em/math/functions.h"
+#include "em/math/namespaces.h"
+#include "em/math/scalar.h"
+#include "em/math/vector.h"
+#include "em/math/vector_functions.h"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+// A fast pseudo-random generator producing scalars and vectors, with span versions of everything.
+
+namespace em::Math
+{
+    namespace detail::Random
+    {
+        // SplitMix64, used to expand the seed into the generator state.
+        [[nodiscard]] EM_TINY constexpr std::uint64_t SplitMix64(std::uint64_t &state) noexcept
+        {
+            std::uint64_t z = (state += 0x9e3779b97f4a7c15);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            return z ^ (z >> 31);
+        }
+
+        // The integral types we can generate in ranges. `bool` is excluded because `std::make_unsigned` rejects it.
+        template <typename T>
+        concept RangeIntegral = integral_scalar<T> && !std::is_same_v<T, bool>;
+    }
+
+    // A xoshiro128++ generator, running `Lanes` independent streams side by side.
+    // The state is stored as structure-of-arrays, so advancing all lanes at once compiles to a few SIMD instructions.
+    // The output only depends on the seed, the stream, and `Lanes`, and is the same on all platforms.
+    //
+    // This satisfies `std::uniform_random_bit_generator`, so it can be used with the standard distributions,
+    //   but the member functions below (and especially the span versions) are much faster than those.
+    // The span versions consume the numbers in the same order as the repeated single-element calls, so you can mix them freely.
+    template <int Lanes = 8> requires (Lanes >= 1)
+    class random_generator
+    {
+        // `state[i][lane]`.
+        std::array<std::array<std::uint32_t, Lanes>, 4> state{};
+        // The numbers that were generated but not returned yet.
+        std::array<std::uint32_t, Lanes> buffer{};
+        int buffer_pos = Lanes;
+
+      public:
+        using result_type = std::uint32_t;
+
+        static constexpr int lanes = Lanes;
+
+        // Generators with the same `seed` but different `stream`s produce independent sequences.
+        // When generating in parallel, use the same seed and the thread index as the stream to get reproducible results.
+        constexpr explicit random_generator(std::uint64_t seed = 0, std::uint64_t stream = 0) noexcept
+        {
+            std::uint64_t mixer = seed ^ detail::Random::SplitMix64(stream);
+            for (int i = 0; i < Lanes; i++)
+            {
+                std::uint64_t a = detail::Random::SplitMix64(mixer);
+                std::uint64_t b = detail::Random::SplitMix64(mixer);
+                state[0][i] = std::uint32_t(a);
+                state[1][i] = std::uint32_t(a >> 32);
+                state[2][i] = std::uint32_t(b);
+                state[3][i] = std::uint32_t(b >> 32);
+
+                // An all-zero state would only produce zeroes. This is astronomically unlikely, but still.
+                if ((a | b) == 0)
+                    state[0][i] = 1;
+            }
+        }
+
+        [[nodiscard]] static constexpr result_type min() noexcept {return 0;}
+        [[nodiscard]] static constexpr result_type max() noexcept {return std::numeric_limits<result_type>::max();}
+
+        // Advances all lanes once, writing one number per lane. This bypasses the internal buffer.
+        constexpr void next_block(std::span<std::uint32_t, Lanes> out) noexcept
+        {
+            auto &[s0, s1, s2, s3] = state;
+            for (int i = 0; i < Lanes; i++)
+            {
+                out[i] = std::rotl(s0[i] + s3[i], 7) + s0[i];
+                std::uint32_t t = s1[i] << 9;
+                s2[i] ^= s0[i];
+                s3[i] ^= s1[i];
+                s1[i] ^= s2[i];
+                s0[i] ^= s3[i];
+                s2[i] ^= t;
+                s3[i] = std::rotl(s3[i], 11);
+            }
+        }
+
+        // Returns a single random number.
+        [[nodiscard]] EM_TINY constexpr result_type operator()() noexcept
+        {
+            if (buffer_pos == Lanes)
+            {
+                next_block(buffer);
+                buffer_pos = 0;
+            }
+            return buffer[buffer_pos++];
+        }
+
+        // Fills the span with random numbers. Same as calling `operator()` repeatedly, but faster.
+        constexpr void fill(std::span<std::uint32_t> out) noexcept
+        {
+            std::size_t i = 0;
+
+            // Use up the buffer first.
+            while (i < out.size() && buffer_pos < Lanes)
+                out[i++] = buffer[buffer_pos++];
+
+            // Then write whole blocks directly.
+            for (; out.size() - i >= std::size_t(Lanes); i += Lanes)
+                next_block(out.subspan(i).template first<Lanes>());
+
+            // Then the remainder.
+            while (i < out.size())
+                out[i++] = (*this)();
+        }
+
+
+        // A random 64-bit number, made of two 32-bit ones.
+        [[nodiscard]] EM_TINY constexpr std::uint64_t next_u64() noexcept
+        {
+            std::uint64_t lo = (*this)();
+            std::uint64_t hi = (*this)();
+            return lo | hi << 32;
+        }
+
+        // For floating-point types returns a number in `[0, 1)`. For integral types returns any value of the type.
+        // For vectors, does that elementwise.
+        template <typename T>
+        [[nodiscard]] constexpr T uniform() noexcept
+        {
+            if constexpr (vector<T>)
+            {
+                T ret;
+                for (int i = 0; i < vec_size<T>; i++)
+                    ret[i] = uniform<vec_base_t<T>>();
+                return ret;
+            }
+            else if constexpr (std::is_same_v<T, float>)
+            {
+                return float((*this)() >> 8) * 0x1p-24f;
+            }
+            else if constexpr (floating_point_scalar<T>)
+            {
+                return T(double(next_u64() >> 11) * 0x1p-53);
+            }
+            else if constexpr (sizeof(T) <= sizeof(std::uint32_t))
+            {
+                return T((*this)());
+            }
+            else
+            {
+                return T(next_u64());
+            }
+        }
+
+        // For integral types returns a number in `[low, high]`, without bias. The bounds must not be inverted.
+        // For floating-point types returns a number in `[low, high)`. The result can be rounded up to `high`, as with `std::uniform_real_distribution`.
+        template <scalar T> requires detail::Random::RangeIntegral<T> || floating_point_scalar<T>
+        [[nodiscard]] constexpr T uniform(T low, T high) noexcept
+        {
+            if constexpr (floating_point_scalar<T>)
+            {
+                return fma(uniform<T>(), high - low, low);
+            }
+            else
+            {
+                using U = std::make_unsigned_t<T>;
+                // The number of possible values minus one.
+                const U range = U(U(high) - U(low));
+
+                if constexpr (sizeof(T) <= sizeof(std::uint32_t))
+                {
+                    // Lemire's nearly divisionless method. The division only happens with the probability of `range / 2^32`.
+                    const std::uint32_t size = std::uint32_t(range) + 1;
+                    if (size == 0)
+                        return T(U(U(low) + U((*this)()))); // The full 32-bit range.
+
+                    std::uint64_t m = std::uint64_t((*this)()) * size;
+                    if (std::uint32_t(m) < size)
+                    {
+                        const std::uint32_t threshold = (0u - size) % size;
+                        while (std::uint32_t(m) < threshold)
+                            m = std::uint64_t((*this)()) * size;
+                    }
+                    return T(U(U(low) + U(m >> 32)));
+                }
+                else
+                {
+                    // Bitmask rejection, this needs less than two tries on average, and doesn't need 128-bit multiplication.
+                    const std::uint64_t mask = ~std::uint64_t(0) >> std::countl_zero(std::uint64_t(range) | 1);
+                    std::uint64_t x = 0;
+                    do
+                        x = next_u64() & mask;
+                    while (x > range);
+                    return T(U(U(low) + U(x)));
+                }
+            }
+        }
+
+        // Elementwise version of the function above. For floating-point vectors, this produces a point uniformly distributed in a box.
+        template <typename T, int N>
+        [[nodiscard]] constexpr vec<T, N> uniform(const vec<T, N> &low, const vec<T, N> &high) noexcept
+        {
+            vec<T, N> ret;
+            for (int i = 0; i < N; i++)
+                ret[i] = uniform(low[i], high[i]);
+            return ret;
+        }
+
+        // A point uniformly distributed inside of a circle of radius 1.
+        template <floating_point_scalar T = float>
+        [[nodiscard]] constexpr vec2<T> in_unit_disk() noexcept
+        {
+            // Rejection sampling, 1.27 tries on average.
+            while (true)
+            {
+                auto ret = uniform(vec2<T>(-1), vec2<T>(1));
+                if (length_sq(ret) < 1)
+                    return ret;
+            }
+        }
+
+        // A point uniformly distributed inside of a sphere of radius 1.
+        template <floating_point_scalar T = float>
+        [[nodiscard]] constexpr vec3<T> in_unit_ball() noexcept
+        {
+            // Rejection sampling, 1.91 tries on average.
+            while (true)
+            {
+                auto ret = uniform(vec3<T>(-1), vec3<T>(1));
+                if (length_sq(ret) < 1)
+                    return ret;
+            }
+        }
+
+        // A point uniformly distributed on a circle of radius 1.
+        template <floating_point_scalar T = float>
+        [[nodiscard]] vec2<T> on_unit_circle() noexcept
+        {
+            // Normalizing a point in a disk. Reject the points near the center where the precision is bad.
+            while (true)
+            {
+                auto ret = uniform(vec2<T>(-1), vec2<T>(1));
+                T len_sq = length_sq(ret);
+                if (len_sq < 1 && len_sq > T(0x1p-12))
+                    return ret / sqrt(len_sq);
+            }
+        }
+
+        // A point uniformly distributed on a sphere of radius 1.
+        template <floating_point_scalar T = float>
+        [[nodiscard]] vec3<T> on_unit_sphere() noexcept
+        {
+            // Same as in `on_unit_circle()`.
+            while (true)
+            {
+                auto ret = uniform(vec3<T>(-1), vec3<T>(1));
+                T len_sq = length_sq(ret);
+                if (len_sq < 1 && len_sq > T(0x1p-12))
+                    return ret / sqrt(len_sq);
+            }
+        }
+
+
+        // Span versions:
+
+        // Fills the span with `uniform<T>()`.
+        template <typename T>
+        constexpr void fill_uniform(std::span<T> out) noexcept
+        {
+            if constexpr (std::is_same_v<T, float>)
+            {
+                // Generate in chunks to let the conversion vectorize.
+                std::array<std::uint32_t, 64> bits{};
+                for (std::size_t i = 0; i < out.size(); i += bits.size())
+                {
+                    std::size_t n = out.size() - i < bits.size() ? out.size() - i : bits.size();
+                    fill(std::span(bits).first(n));
+                    for (std::size_t j = 0; j < n; j++)
+                        out[i + j] = float(bits[j] >> 8) * 0x1p-24f;
+                }
+            }
+            else
+            {
+                for (T &elem : out)
+                    elem = uniform<T>();
+            }
+        }
+
+        // Fills the span with `uniform(low, high)`.
+        template <typename T>
+        constexpr void fill_uniform(std::span<T> out, const std::type_identity_t<T> &low, const std::type_identity_t<T> &high) noexcept
+        {
+            if constexpr (floating_point_scalar<T>)
+            {
+                fill_uniform(out);
+                const T size = high - low;
+                for (T &elem : out)
+                    elem = fma(elem, size, low);
+            }
+            else
+            {
+                for (T &elem : out)
+                    elem = uniform(low, high);
+            }
+        }
+
+        // Fill the span with points in/on a circle/sphere, see the single-element functions above.
+        template <floating_point_scalar T> constexpr void fill_in_unit_disk(std::span<vec2<T>> out) noexcept {for (auto &elem : out) elem = in_unit_disk<T>();}
+        template <floating_point_scalar T> constexpr void fill_in_unit_ball(std::span<vec3<T>> out) noexcept {for (auto &elem : out) elem = in_unit_ball<T>();}
+        template <floating_point_scalar T> void fill_on_unit_circle(std::span<vec2<T>> out) noexcept {for (auto &elem : out) elem = on_unit_circle<T>();}
+        template <floating_point_scalar T> void fill_on_unit_sphere(std::span<vec3<T>> out) noexcept {for (auto &elem : out) elem = on_unit_sphere<T>();}
+    };
+
+    inline namespace Common
+    {
+        using Math::random_generator;
+    }
+}
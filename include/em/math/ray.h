@@ -0,0 +1,317 @@
+#pragma once
+
+#include "em/macros/portable/if_consteval.h"
+#include "em/macros/portable/tiny_func.h"
+#include "em/math/namespaces.h"
+#include "em/math/rect.h"
+#include "em/math/scalar.h"
+#include "em/math/vector.h"
+#include "em/math/vector_functions.h"
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+// Rays, and their intersections with boxes and triangles, both one at a time and in packets of 4 or 8 (structure-of-arrays), which vectorize well.
+//
+// The distances along the ray are in the units of `ray::dir`, so they're the real distances only if `dir` is normalized.
+// Everything here is branchless on the hot paths, and handles zero direction components (and the resulting infinities) correctly.
+
+namespace em::Math
+{
+    namespace detail::Ray
+    {
+        template <typename T>
+        constexpr T inf = std::numeric_limits<T>::infinity();
+
+        // `1 / x`, but gives the infinity with the right sign for `x == +-0` (also in constant evaluation, where dividing by zero is an error).
+        template <floating_point_scalar T>
+        [[nodiscard]] EM_TINY constexpr T Reciprocal(T x) noexcept
+        {
+            if (x != 0)
+                return 1 / x;
+
+            bool negative = false;
+            if constexpr (sizeof(T) == sizeof(std::uint32_t))
+                negative = std::bit_cast<std::uint32_t>(x) >> 31;
+            else if constexpr (sizeof(T) == sizeof(std::uint64_t))
+                negative = std::bit_cast<std::uint64_t>(x) >> 63;
+            else
+                negative = std::signbit(x);
+            return negative ? -inf<T> : inf<T>;
+        }
+
+        // `d * inv_d` for the slab test. `0 * inf` gives NaN as usual, but without failing the constant evaluation.
+        template <floating_point_scalar T>
+        [[nodiscard]] EM_TINY constexpr T SlabDistance(T d, T inv_d) noexcept
+        {
+            EM_IF_CONSTEVAL
+            {
+                if (d == 0 && (inv_d == inf<T> || inv_d == -inf<T>))
+                    return std::numeric_limits<T>::quiet_NaN();
+            }
+            return d * inv_d;
+        }
+    }
+
+    // A ray starting at `origin`, going in the direction `dir`.
+    template <floating_point_scalar T, int N = 3>
+    struct ray
+    {
+        vec<T, N> origin;
+        vec<T, N> dir;
+
+        // The point at the distance `t`.
+        [[nodiscard]] constexpr vec<T, N> at(T t) const {return fma(dir, vec<T, N>(t), origin);}
+    };
+
+
+    // Ray-box intersections:
+
+    // A ray prepared for intersecting with many boxes, and the range of distances we're interested in.
+    template <floating_point_scalar T, int N = 3>
+    struct ray_box_query
+    {
+        vec<T, N> origin;
+        // `1 / dir`. Can have infinities.
+        vec<T, N> inv_dir;
+        // Whether each component of `dir` is negative (including `-0`). Then the slab is entered through the max side.
+        vec<bool, N> negative;
+        // The range of distances.
+        T t_min = 0;
+        T t_max = detail::Ray::inf<T>;
+
+        constexpr ray_box_query() {}
+        constexpr ray_box_query(const ray<T, N> &r, std::type_identity_t<T> t_min = 0, std::type_identity_t<T> t_max = detail::Ray::inf<T>)
+            : origin(r.origin), t_min(t_min), t_max(t_max)
+        {
+            for (int i = 0; i < N; i++)
+            {
+                inv_dir[i] = detail::Ray::Reciprocal(r.dir[i]);
+                negative[i] = inv_dir[i] < 0;
+            }
+        }
+    };
+
+    // `W` boxes in the structure-of-arrays form: `min[axis][lane]` and `max[axis][lane]`.
+    // The unused lanes are inverted boxes (`min = +inf`, `max = -inf`) by default, which never get hit.
+    template <floating_point_scalar T, int W, int N = 3>
+    struct box_packet
+    {
+        static constexpr int width = W;
+
+        std::array<std::array<T, W>, N> min;
+        std::array<std::array<T, W>, N> max;
+
+        constexpr box_packet()
+        {
+            for (int i = 0; i < N; i++)
+            {
+                min[std::size_t(i)].fill(detail::Ray::inf<T>);
+                max[std::size_t(i)].fill(-detail::Ray::inf<T>);
+            }
+        }
+
+        // Sets one of the boxes.
+        constexpr void set(int lane, const rect<T, N> &box)
+        {
+            for (int i = 0; i < N; i++)
+            {
+                min[std::size_t(i)][std::size_t(lane)] = box.a[i];
+                max[std::size_t(i)][std::size_t(lane)] = box.b[i];
+            }
+        }
+    };
+
+    // The slab test. Returns the distance at which the ray enters the box (at least `t_min`), or `+inf` if it misses the box.
+    // The boxes are treated as closed here. The rays lying exactly in the plane of a face hit the box.
+    template <floating_point_scalar T, int N>
+    [[nodiscard]] constexpr T intersect_ray_box(const ray_box_query<T, N> &query, const rect<T, N> &box) noexcept
+    {
+        T t_near = query.t_min;
+        T t_far = query.t_max;
+        for (int i = 0; i < N; i++)
+        {
+            // Picking the near and far sides by the direction sign instead of `min()/max()` of the two distances.
+            // If the origin is exactly on the side and the direction component is zero, we get `0 * inf = NaN`, and the comparisons below ignore it.
+            const T lo = detail::Ray::SlabDistance((query.negative[i] ? box.b[i] : box.a[i]) - query.origin[i], query.inv_dir[i]);
+            const T hi = detail::Ray::SlabDistance((query.negative[i] ? box.a[i] : box.b[i]) - query.origin[i], query.inv_dir[i]);
+            t_near = lo > t_near ? lo : t_near;
+            t_far = hi < t_far ? hi : t_far;
+        }
+        return t_near <= t_far ? t_near : detail::Ray::inf<T>;
+    }
+
+    // Same, but for `W` boxes at once. Returns the distances for each box, `+inf` for the boxes that were missed.
+    template <floating_point_scalar T, int W, int N>
+    [[nodiscard]] constexpr std::array<T, W> intersect_ray_box_packet(const ray_box_query<T, N> &query, const box_packet<T, W, N> &boxes) noexcept
+    {
+        std::array<T, W> t_near, t_far;
+        t_near.fill(query.t_min);
+        t_far.fill(query.t_max);
+
+        for (int i = 0; i < N; i++)
+        {
+            // The direction sign is the same for all lanes, so we choose between the arrays instead of choosing in each lane.
+            const std::array<T, W> &near_side = query.negative[i] ? boxes.max[std::size_t(i)] : boxes.min[std::size_t(i)];
+            const std::array<T, W> &far_side = query.negative[i] ? boxes.min[std::size_t(i)] : boxes.max[std::size_t(i)];
+            const T o = query.origin[i];
+            const T inv = query.inv_dir[i];
+
+            for (std::size_t j = 0; j < std::size_t(W); j++)
+            {
+                const T lo = detail::Ray::SlabDistance(near_side[j] - o, inv);
+                const T hi = detail::Ray::SlabDistance(far_side[j] - o, inv);
+                t_near[j] = lo > t_near[j] ? lo : t_near[j];
+                t_far[j] = hi < t_far[j] ? hi : t_far[j];
+            }
+        }
+
+        std::array<T, W> ret;
+        for (std::size_t j = 0; j < std::size_t(W); j++)
+            ret[j] = t_near[j] <= t_far[j] ? t_near[j] : detail::Ray::inf<T>;
+        return ret;
+    }
+
+
+    // Ray-triangle intersections:
+
+    // The result of a ray-triangle intersection.
+    template <floating_point_scalar T>
+    struct ray_triangle_hit
+    {
+        // The distance, or `+inf` if nothing was hit.
+        T t = detail::Ray::inf<T>;
+        // The barycentric coordinates of the hit point: it's `v0 * (1 - u - v) + v1 * u + v2 * v`.
+        T u = 0;
+        T v = 0;
+        // Which triangle was hit, for the functions testing several triangles. `-1` if nothing was hit.
+        int index = -1;
+
+        [[nodiscard]] explicit constexpr operator bool() const noexcept {return index != -1;}
+    };
+
+    // `W` triangles in the structure-of-arrays form, stored as the first vertex and two edges: `v0[axis][lane]`, etc.
+    // The unused lanes are degenerate by default, which never get hit.
+    template <floating_point_scalar T, int W>
+    struct triangle_packet
+    {
+        static constexpr int width = W;
+
+        std::array<std::array<T, W>, 3> v0{};
+        // `v1 - v0`.
+        std::array<std::array<T, W>, 3> e1{};
+        // `v2 - v0`.
+        std::array<std::array<T, W>, 3> e2{};
+
+        // Sets one of the triangles.
+        constexpr void set(int lane, const vec3<T> &a, const vec3<T> &b, const vec3<T> &c)
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                v0[std::size_t(i)][std::size_t(lane)] = a[i];
+                e1[std::size_t(i)][std::size_t(lane)] = b[i] - a[i];
+                e2[std::size_t(i)][std::size_t(lane)] = c[i] - a[i];
+            }
+        }
+    };
+
+    namespace detail::Ray
+    {
+        // The Moller-Trumbore algorithm, on individual components to be usable in packets.
+        // Returns `t`, or `+inf` on a miss. Both sides of the triangle are hit.
+        // Instead of checking the determinant for zero, we replace it with NaN, which makes all comparisons fail. This also works in constant evaluation.
+        template <typename T>
+        [[nodiscard]] EM_TINY constexpr T MollerTrumbore(const ray<T, 3> &r, const vec3<T> &v0, const vec3<T> &e1, const vec3<T> &e2, T t_min, T t_max, T &out_u, T &out_v) noexcept
+        {
+            const vec3<T> p = cross(r.dir, e2);
+            const T det = dot(e1, p);
+            const T inv_det = 1 / (det == 0 ? std::numeric_limits<T>::quiet_NaN() : det);
+
+            const vec3<T> s = r.origin - v0;
+            const T u = dot(s, p) * inv_det;
+            const vec3<T> q = cross(s, e1);
+            const T v = dot(r.dir, q) * inv_det;
+            const T t = dot(e2, q) * inv_det;
+
+            out_u = u;
+            out_v = v;
+            const bool hit = (u >= 0) & (v >= 0) & (u + v <= 1) & (t >= t_min) & (t <= t_max);
+            return hit ? t : inf<T>;
+        }
+    }
+
+    // Intersects a ray with a triangle. Both sides of the triangle are hit. Only returns hits with the distance in `[t_min, t_max]`.
+    template <floating_point_scalar T>
+    [[nodiscard]] constexpr ray_triangle_hit<T> intersect_ray_triangle(const ray<T, 3> &r, const vec3<T> &a, const vec3<T> &b, const vec3<T> &c, std::type_identity_t<T> t_min = 0, std::type_identity_t<T> t_max = detail::Ray::inf<T>) noexcept
+    {
+        ray_triangle_hit<T> ret;
+        T u{}, v{};
+        T t = detail::Ray::MollerTrumbore(r, a, b - a, c - a, t_min, t_max, u, v);
+        if (t != detail::Ray::inf<T>)
+            ret = {t, u, v, 0};
+        return ret;
+    }
+
+    // Intersects a ray with `W` triangles at once, returns the nearest hit. The hit index is the lane.
+    template <floating_point_scalar T, int W>
+    [[nodiscard]] constexpr ray_triangle_hit<T> intersect_ray_triangle_packet(const ray<T, 3> &r, const triangle_packet<T, W> &tris, std::type_identity_t<T> t_min = 0, std::type_identity_t<T> t_max = detail::Ray::inf<T>) noexcept
+    {
+        std::array<T, W> t, u, v;
+        for (std::size_t j = 0; j < std::size_t(W); j++)
+        {
+            t[j] = detail::Ray::MollerTrumbore(
+                r,
+                vec3<T>(tris.v0[0][j], tris.v0[1][j], tris.v0[2][j]),
+                vec3<T>(tris.e1[0][j], tris.e1[1][j], tris.e1[2][j]),
+                vec3<T>(tris.e2[0][j], tris.e2[1][j], tris.e2[2][j]),
+                t_min, t_max, u[j], v[j]
+            );
+        }
+
+        ray_triangle_hit<T> ret;
+        for (std::size_t j = 0; j < std::size_t(W); j++)
+        {
+            if (t[j] < ret.t)
+                ret = {t[j], u[j], v[j], int(j)};
+        }
+        return ret;
+    }
+
+    // Intersects a ray with a list of triangle packets, returns the nearest hit. The hit index is `packet_index * W + lane`.
+    template <floating_point_scalar T, int W>
+    [[nodiscard]] constexpr ray_triangle_hit<T> intersect_ray_triangles(const ray<T, 3> &r, std::span<const triangle_packet<T, W>> packets, std::type_identity_t<T> t_min = 0, std::type_identity_t<T> t_max = detail::Ray::inf<T>) noexcept
+    {
+        ray_triangle_hit<T> ret;
+        for (std::size_t i = 0; i < packets.size(); i++)
+        {
+            // Shrinking `t_max` as we go, to skip the farther hits.
+            ray_triangle_hit<T> hit = intersect_ray_triangle_packet(r, packets[i], t_min, ret.t < t_max ? ret.t : t_max);
+            if (hit)
+            {
+                ret = hit;
+                ret.index += int(i) * W;
+            }
+        }
+        return ret;
+    }
+
+    inline namespace Common
+    {
+        using Math::ray;
+        using Math::ray_box_query;
+        using Math::box_packet;
+        using Math::triangle_packet;
+        using Math::ray_triangle_hit;
+        using Math::intersect_ray_box;
+        using Math::intersect_ray_box_packet;
+        using Math::intersect_ray_triangle;
+        using Math::intersect_ray_triangle_packet;
+        using Math::intersect_ray_triangles;
+    }
+}
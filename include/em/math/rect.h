@@ -0,0 +1,316 @@
+#pragma once
+
+#include "em/macros/portable/tiny_func.h"
+#include "em/macros/utils/forward.h"
+#include "em/macros/utils/returns.h"
+#include "em/math/min_max.h"
+#include "em/math/namespaces.h"
+#include "em/math/type_shorthands.h"
+#include "em/math/vector.h"
+#include "em/meta/common.h"
+#include "em/meta/functional.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+// Axis-aligned boxes.
+
+namespace em::Math
+{
+    // Define typedefs: `TrectN`, `Trect<N>`, `rectN<T>`.
+    EM_MATH_TYPE_SHORTHANDS_VEC(
+        (template <Meta::cvref_unqualified T, int N> requires detail::Vector::ValidSize<N> struct),
+        rect
+    )
+
+    namespace detail::Rect
+    {
+        // A base class of `rect`, to make ADL find the functions in this namespace.
+        struct Base {};
+
+        template <typename T> struct IsRect : std::false_type {};
+        template <typename T, int N> struct IsRect<rect<T, N>> : std::true_type {};
+    }
+
+    // Vectors should let rects handle `apply_elementwise()` when they're mixed together.
+    namespace Customize
+    {
+        template <typename T, int N>
+        struct ContainsVectorsElementwise<rect<T, N>> : std::true_type {};
+    }
+
+    // Whether `T` is a `rect<...>`, maybe cvref-qualified.
+    template <typename T> concept rect_cvref = detail::Rect::IsRect<std::remove_cvref_t<T>>::value;
+
+    // An axis-aligned box, with the corners `a` (the minimum, inclusive) and `b` (the maximum, exclusive).
+    // The box is empty if `b <= a` in at least one dimension.
+    // Elementwise functions and operators act on both corners, e.g. `rect + vec` moves the rect, and `rect * scalar` scales it.
+    template <Meta::cvref_unqualified T, int N> requires detail::Vector::ValidSize<N>
+    struct rect : VectorOps::EnableVectorOps<rect<T, N>>, detail::Rect::Base
+    {
+        static constexpr int dims = N;
+        using type = T;
+        using vec_type = vec<T, N>;
+
+        vec_type a;
+        vec_type b;
+
+        constexpr rect() {}
+        constexpr rect(vec_type a, vec_type b) : a(std::move(a)), b(std::move(b)) {}
+
+        // Makes a rect from the minimum corner and the size.
+        [[nodiscard]] static constexpr rect from_pos_size(const vec_type &pos, const vec_type &size)
+        {
+            return rect(pos, pos + size);
+        }
+
+        [[nodiscard]] constexpr vec_type size() const {return b - a;}
+        [[nodiscard]] constexpr vec_type center() const {return (a + b) / 2;}
+
+        // Returns true if the rect has no points.
+        [[nodiscard]] constexpr bool empty() const
+        {
+            for (int i = 0; i < N; i++)
+            {
+                if (!(a[i] < b[i]))
+                    return true;
+            }
+            return false;
+        }
+
+        // Returns true if the point is inside. Since the rect is half-open, the points on the max boundary aren't inside.
+        [[nodiscard]] constexpr bool contains(const vec_type &point) const
+        {
+            bool ret = true;
+            for (int i = 0; i < N; i++)
+                ret &= (a[i] <= point[i]) & (point[i] < b[i]);
+            return ret;
+        }
+        // Returns true if every point of `other` is inside. Empty rects are contained in everything.
+        [[nodiscard]] constexpr bool contains(const rect &other) const
+        {
+            if (other.empty())
+                return true;
+            bool ret = true;
+            for (int i = 0; i < N; i++)
+                ret &= (a[i] <= other.a[i]) & (other.b[i] <= b[i]);
+            return ret;
+        }
+
+        // Returns true if the rects have common points. Rects that only touch don't overlap.
+        [[nodiscard]] EM_TINY constexpr bool overlaps(const rect &other) const
+        {
+            bool ret = true;
+            for (int i = 0; i < N; i++)
+                ret &= max(a[i], other.a[i]) < min(b[i], other.b[i]);
+            return ret;
+        }
+
+        // The common part of two rects. Can be empty.
+        [[nodiscard]] constexpr rect intersect(const rect &other) const
+        {
+            return rect(max(a, other.a), min(b, other.b));
+        }
+        // The smallest rect containing both rects. This doesn't check for empty rects, so you might want to check this yourself.
+        [[nodiscard]] constexpr rect unite(const rect &other) const
+        {
+            return rect(min(a, other.a), max(b, other.b));
+        }
+
+        // Moves every side outwards by `delta` (a vector or a scalar). Negative values shrink the rect.
+        [[nodiscard]] constexpr rect expand(const auto &delta) const
+        {
+            return rect(vec_type(a - delta), vec_type(b + delta));
+        }
+        // Grows the rect to contain `point`. For integral rects this makes `b` at least `point + 1`, for floating-point ones just `point`.
+        [[nodiscard]] constexpr rect expand_to_contain(const vec_type &point) const
+        {
+            if constexpr (std::is_integral_v<T>)
+                return rect(min(a, point), max(b, vec_type(point + 1)));
+            else
+                return rect(min(a, point), max(b, point));
+        }
+
+
+        // Iterating over the integer points, X changes the fastest.
+        class iterator
+        {
+            vec_type pos;
+            vec_type min_pos;
+            vec_type max_pos;
+
+          public:
+            using value_type = vec_type;
+            using difference_type = std::ptrdiff_t;
+
+            constexpr iterator() {}
+
+            constexpr iterator(const rect &r) : pos(r.a), min_pos(r.a), max_pos(r.b)
+            {
+                // Empty rects start at the end.
+                if (r.empty())
+                    pos[N - 1] = max_pos[N - 1];
+            }
+
+            [[nodiscard]] constexpr const vec_type &operator*() const {return pos;}
+            [[nodiscard]] constexpr const vec_type *operator->() const {return &pos;}
+
+            constexpr iterator &operator++()
+            {
+                int i = 0;
+                while (i < N - 1 && ++pos[i] == max_pos[i])
+                {
+                    pos[i] = min_pos[i];
+                    i++;
+                }
+                if (i == N - 1)
+                    ++pos[i];
+                return *this;
+            }
+            constexpr iterator operator++(int)
+            {
+                iterator ret = *this;
+                ++*this;
+                return ret;
+            }
+
+            [[nodiscard]] constexpr bool operator==(std::default_sentinel_t) const
+            {
+                return pos[N - 1] == max_pos[N - 1];
+            }
+        };
+
+        [[nodiscard]] constexpr iterator begin() const requires std::is_integral_v<T> {return iterator(*this);}
+        [[nodiscard]] constexpr std::default_sentinel_t end() const requires std::is_integral_v<T> {return {};}
+    };
+
+    template <typename T, int N>
+    rect(vec<T, N>, vec<T, N>) -> rect<T, N>;
+
+
+    // Implement `apply_elementwise()` and `any_of_elementwise()` for rects, by applying to `a` and `b`.
+    namespace detail::Rect
+    {
+        // At least one parameter must be a rect. With `SameKind`, all of them must be.
+        template <bool SameKind, typename ...P>
+        concept RectParams = SameKind ? (rect_cvref<P> && ...) : (rect_cvref<P> || ...);
+
+        // Returns `a` or `b` for rects, and the parameter itself for everything else.
+        template <typename T>
+        [[nodiscard]] constexpr auto &&RectElem(int i, T &&param) noexcept
+        {
+            if constexpr (rect_cvref<T>)
+                return i == 0 ? EM_FWD(param).a : EM_FWD(param).b;
+            else
+                return param; // Intentionally no forwarding, since it's used twice.
+        }
+
+        template <bool SameKind, typename F, typename ...P> requires RectParams<SameKind, P...> constexpr auto _adl_em_apply_elementwise(F &&func, P &&... params) EM_RETURNS(rect(std::invoke(func, (RectElem)(0, EM_FWD(params))...), std::invoke(func, (RectElem)(1, EM_FWD(params))...)))
+        // Same for `void` return type:
+        template <bool SameKind, typename F, typename ...P> requires RectParams<SameKind, P...> constexpr auto _adl_em_apply_elementwise(F &&func, P &&... params) EM_RETURNS(Meta::invoke_void(func, (RectElem)(0, EM_FWD(params))...), Meta::invoke_void(func, (RectElem)(1, EM_FWD(params))...))
+
+        template <bool SameKind, typename F, typename ...P> requires RectParams<SameKind, P...> constexpr auto _adl_em_any_of_elementwise(F &&func, P &&... params) noexcept(noexcept(auto(std::invoke(func, (RectElem)(0, EM_FWD(params))...)))) -> decltype(auto(std::invoke(func, (RectElem)(0, EM_FWD(params))...))) {if (auto d = std::invoke(func, (RectElem)(0, EM_FWD(params))...)) return d; if (auto d = std::invoke(func, (RectElem)(1, EM_FWD(params))...)) return d; return {};}
+    }
+
+
+    // Batch queries:
+
+    // A structure-of-arrays list of rects: `a[i][j]` and `b[i][j]` are the components `i` of the corners of the rect `j`.
+    // All spans must have the same size.
+    template <typename T, int N>
+    struct rect_soa_view
+    {
+        std::array<std::span<const T>, N> a;
+        std::array<std::span<const T>, N> b;
+
+        [[nodiscard]] constexpr std::size_t size() const {return a[0].size();}
+    };
+
+    namespace detail::Rect
+    {
+        template <typename T, int N>
+        constexpr void CheckSoaSizes(const rect_soa_view<T, N> &rects)
+        {
+            for (int i = 0; i < N; i++)
+            {
+                if (rects.a[std::size_t(i)].size() != rects.size() || rects.b[std::size_t(i)].size() != rects.size())
+                    throw std::length_error("The spans of the structure-of-arrays rects have different sizes.");
+            }
+        }
+
+        // Calls `func(i, overlaps)` for every rect, where `overlaps` is `query.overlaps(rects[i])`.
+        // This is branchless, so it vectorizes.
+        template <typename T, int N>
+        EM_TINY constexpr void ForEachOverlap(const rect<T, N> &query, std::span<const rect<T, N>> rects, auto &&func)
+        {
+            for (std::size_t i = 0; i < rects.size(); i++)
+                func(i, query.overlaps(rects[i]));
+        }
+        template <typename T, int N>
+        EM_TINY constexpr void ForEachOverlap(const rect<T, N> &query, const rect_soa_view<T, N> &rects, auto &&func)
+        {
+            CheckSoaSizes(rects);
+            for (std::size_t i = 0; i < rects.size(); i++)
+            {
+                bool ret = true;
+                for (int j = 0; j < N; j++)
+                    ret &= max(query.a[j], rects.a[std::size_t(j)][i]) < min(query.b[j], rects.b[std::size_t(j)][i]);
+                func(i, ret);
+            }
+        }
+    }
+
+    // Sets `out_mask[i]` to `query.overlaps(rects[i])`.
+    template <typename T, int N>
+    constexpr void rect_overlap_mask(const rect<T, N> &query, std::type_identity_t<std::span<const rect<T, N>>> rects, std::span<bool> out_mask)
+    {
+        if (out_mask.size() < rects.size())
+            throw std::length_error("The output span is smaller than the input.");
+        detail::Rect::ForEachOverlap(query, rects, [&](std::size_t i, bool overlaps){out_mask[i] = overlaps;});
+    }
+    template <typename T, int N>
+    constexpr void rect_overlap_mask(const rect<T, N> &query, const std::type_identity_t<rect_soa_view<T, N>> &rects, std::span<bool> out_mask)
+    {
+        if (out_mask.size() < rects.size())
+            throw std::length_error("The output span is smaller than the input.");
+        detail::Rect::ForEachOverlap(query, rects, [&](std::size_t i, bool overlaps){out_mask[i] = overlaps;});
+    }
+
+    // Writes the indices of the rects overlapping `query` into `out_indices`, and returns how many of them there are.
+    // `out_indices` must be at least as large as `rects`, because the writes are unconditional (to avoid branches).
+    template <typename T, int N>
+    constexpr std::size_t rect_overlap_indices(const rect<T, N> &query, std::type_identity_t<std::span<const rect<T, N>>> rects, std::span<std::uint32_t> out_indices)
+    {
+        if (out_indices.size() < rects.size())
+            throw std::length_error("The output span is smaller than the input.");
+        std::size_t count = 0;
+        detail::Rect::ForEachOverlap(query, rects, [&](std::size_t i, bool overlaps){out_indices[count] = std::uint32_t(i); count += overlaps;});
+        return count;
+    }
+    template <typename T, int N>
+    constexpr std::size_t rect_overlap_indices(const rect<T, N> &query, const std::type_identity_t<rect_soa_view<T, N>> &rects, std::span<std::uint32_t> out_indices)
+    {
+        if (out_indices.size() < rects.size())
+            throw std::length_error("The output span is smaller than the input.");
+        std::size_t count = 0;
+        detail::Rect::ForEachOverlap(query, rects, [&](std::size_t i, bool overlaps){out_indices[count] = std::uint32_t(i); count += overlaps;});
+        return count;
+    }
+}
+
+// Expose `rect` and its typedefs into the `Common` namespace.
+namespace em::Math::inline Common
+{
+    using Math::rect;
+    EM_MATH_IMPORT_TYPE_SHORTHANDS_VEC(Math::,rect)
+
+    using Math::rect_soa_view;
+    using Math::rect_overlap_mask;
+    using Math::rect_overlap_indices;
+}
@@ -11,6 +11,7 @@
 #include <compare>
 #include <concepts>
 #include <limits>
+#include <span>
 #include <stdexcept>
 #include <type_traits>
 #include <utility>
@@ -213,4 +214,195 @@ namespace em::Math::Robust
             return result;
         }
     )
+
+    // Overflow-checked arithmetic on integers and vectors of them. Those compute the result as if with infinite precision, and then check if it fits into the result type.
+    // This uses the `__builtin_*_overflow()` intrinsics where available, otherwise it's emulated (slower, but still branchless for addition and subtraction).
+    // The result type is the `larger_t` of the operands, same as for the normal operators, so mixing signedness is a compile-time error.
+
+    // The result of a checked operation. For vectors, `overflow` is a vector of bools, one per element.
+    // On overflow, `value` is wrapped around (as if computed with infinite precision and then truncated).
+    template <typename T, typename F = bool>
+    struct checked_result
+    {
+        T value{};
+        F overflow{};
+
+        [[nodiscard]] constexpr bool any_overflow() const
+        {
+            return bool(any_of_elementwise([](bool b){return b;}, overflow));
+        }
+
+        [[nodiscard]] friend constexpr bool operator==(const checked_result &, const checked_result &) = default;
+    };
+
+    namespace detail::Checked
+    {
+        template <typename T>
+        concept Integer = integral_scalar<T> && !std::is_same_v<T, bool>;
+
+        #if defined(__GNUC__) || defined(__clang__)
+        #define DETAIL_EM_CHECKED_BUILTINS 1
+        #else
+        #define DETAIL_EM_CHECKED_BUILTINS 0
+        #endif
+
+        // The unsigned type to do the wrapping arithmetic in, at least `unsigned int`, so the small types aren't promoted to `int` and can't overflow.
+        template <Integer R>
+        using Unsigned = std::common_type_t<std::make_unsigned_t<R>, unsigned int>;
+
+        // Compute the result into the last parameter, and return true on overflow.
+        // Both operands are representable in the result type, since `larger_t` doesn't mix signedness.
+        struct Add
+        {
+            template <Integer A, Integer B>
+            static constexpr bool Run(A a, B b, larger_t<A, B> &result)
+            {
+                #if DETAIL_EM_CHECKED_BUILTINS
+                return __builtin_add_overflow(a, b, &result);
+                #else
+                using R = larger_t<A, B>;
+                using U = Unsigned<R>;
+                result = R(U(a) + U(b));
+                if constexpr (std::is_signed_v<R>)
+                    return b > 0 ? R(a) > std::numeric_limits<R>::max() - R(b) : R(a) < std::numeric_limits<R>::min() - R(b);
+                else
+                    return result < R(a);
+                #endif
+            }
+        };
+        struct Sub
+        {
+            template <Integer A, Integer B>
+            static constexpr bool Run(A a, B b, larger_t<A, B> &result)
+            {
+                #if DETAIL_EM_CHECKED_BUILTINS
+                return __builtin_sub_overflow(a, b, &result);
+                #else
+                using R = larger_t<A, B>;
+                using U = Unsigned<R>;
+                result = R(U(a) - U(b));
+                if constexpr (std::is_signed_v<R>)
+                    return b > 0 ? R(a) < std::numeric_limits<R>::min() + R(b) : R(a) > std::numeric_limits<R>::max() + R(b);
+                else
+                    return R(a) < R(b);
+                #endif
+            }
+        };
+        struct Mul
+        {
+            template <Integer A, Integer B>
+            static constexpr bool Run(A a, B b, larger_t<A, B> &result)
+            {
+                #if DETAIL_EM_CHECKED_BUILTINS
+                return __builtin_mul_overflow(a, b, &result);
+                #else
+                using R = larger_t<A, B>;
+                using U = Unsigned<R>;
+                result = R(U(a) * U(b));
+                const R x = R(a), y = R(b);
+                if (x == 0 || y == 0)
+                    return false;
+                if constexpr (std::is_signed_v<R>)
+                {
+                    // The divisions round towards zero, which gives the right bounds for all sign combinations.
+                    if (x > 0)
+                        return y > 0 ? x > std::numeric_limits<R>::max() / y : y < std::numeric_limits<R>::min() / x;
+                    else
+                        return y > 0 ? x < std::numeric_limits<R>::min() / y : x < std::numeric_limits<R>::max() / y;
+                }
+                else
+                {
+                    return y > std::numeric_limits<R>::max() / x;
+                }
+                #endif
+            }
+        };
+        struct Neg
+        {
+            template <Integer A>
+            static constexpr bool Run(A a, A &result)
+            {
+                #if DETAIL_EM_CHECKED_BUILTINS
+                return __builtin_sub_overflow(A(0), a, &result);
+                #else
+                result = A(Unsigned<A>(0) - Unsigned<A>(a));
+                if constexpr (std::is_signed_v<A>)
+                    return a == std::numeric_limits<A>::min();
+                else
+                    return a != 0;
+                #endif
+            }
+        };
+
+        #undef DETAIL_EM_CHECKED_BUILTINS
+
+        // Applies `Op` elementwise, returns the result and the per-element flags.
+        // The lambdas below only accept scalars, so `apply_elementwise()` doesn't try to call them on vectors directly.
+        template <typename Op>
+        [[nodiscard]] constexpr auto Apply(const auto &... params)
+        {
+            using value_type = larger_t<std::remove_cvref_t<decltype(params)>...>;
+            using overflow_type = decltype(apply_elementwise([]<Integer ...X>(X...){return false;}, params...));
+
+            // One pass, writing both the value and the flag of each element.
+            checked_result<value_type, overflow_type> ret;
+            apply_elementwise([]<Integer ...X>(larger_t<X...> &value, bool &overflow, X... x){overflow = Op::Run(x..., value);}, ret.value, ret.overflow, params...);
+            return ret;
+        }
+
+        // Applies `Op` elementwise, replacing the overflowed elements with the respective elements of `fallback` (which can be a scalar).
+        template <typename Op>
+        [[nodiscard]] constexpr auto ApplyOr(const auto &fallback, const auto &... params)
+        {
+            return apply_elementwise([]<typename F, Integer ...X>(const F &f, X... x){larger_t<X...> r; return Op::Run(x..., r) ? larger_t<X...>(f) : r;}, fallback, params...);
+        }
+
+        // Applies `Op` elementwise, ORing the overflow flags into `overflow` instead of returning them.
+        template <typename Op>
+        [[nodiscard]] constexpr auto ApplyAccumulate(bool &overflow, const auto &... params)
+        {
+            return apply_elementwise([&overflow]<Integer ...X>(X... x){larger_t<X...> r; overflow |= Op::Run(x..., r); return r;}, params...);
+        }
+    }
+
+    // Return `checked_result`s.
+    EM_SIMPLE_FUNCTOR( checked_add,, (const auto &a, const auto &b) EM_RETURNS(detail::Checked::Apply<detail::Checked::Add>(a, b)) )
+    EM_SIMPLE_FUNCTOR( checked_sub,, (const auto &a, const auto &b) EM_RETURNS(detail::Checked::Apply<detail::Checked::Sub>(a, b)) )
+    EM_SIMPLE_FUNCTOR( checked_mul,, (const auto &a, const auto &b) EM_RETURNS(detail::Checked::Apply<detail::Checked::Mul>(a, b)) )
+    EM_SIMPLE_FUNCTOR( checked_neg,, (const auto &a) EM_RETURNS(detail::Checked::Apply<detail::Checked::Neg>(a)) )
+
+    // Return the result directly, with the overflowed elements replaced with `fallback` (a scalar or a vector).
+    EM_SIMPLE_FUNCTOR( checked_add_or,, (const auto &a, const auto &b, const auto &fallback) EM_RETURNS(detail::Checked::ApplyOr<detail::Checked::Add>(fallback, a, b)) )
+    EM_SIMPLE_FUNCTOR( checked_sub_or,, (const auto &a, const auto &b, const auto &fallback) EM_RETURNS(detail::Checked::ApplyOr<detail::Checked::Sub>(fallback, a, b)) )
+    EM_SIMPLE_FUNCTOR( checked_mul_or,, (const auto &a, const auto &b, const auto &fallback) EM_RETURNS(detail::Checked::ApplyOr<detail::Checked::Mul>(fallback, a, b)) )
+    EM_SIMPLE_FUNCTOR( checked_neg_or,, (const auto &a, const auto &fallback) EM_RETURNS(detail::Checked::ApplyOr<detail::Checked::Neg>(fallback, a)) )
+
+    // The same operations on spans of integers or vectors, writing to `out` (which can be the same as one of the inputs).
+    // Each returns true if anything overflowed, and the overflowed elements are wrapped around.
+    // The flags are ORed together instead of branching on every element, so the loops stay tight.
+    template <typename T>
+    struct checked_batch
+    {
+      private:
+        template <typename Op>
+        [[nodiscard]] static constexpr bool Run(std::span<T> out, auto... inputs)
+        {
+            const std::size_t n = (inputs.size(), ...);
+            if (((inputs.size() != n) || ...))
+                throw std::length_error("The spans for checked arithmetic have different sizes.");
+            if (out.size() < n)
+                throw std::length_error("The output span for checked arithmetic is too small.");
+
+            bool overflow = false;
+            for (std::size_t i = 0; i < n; i++)
+                out[i] = detail::Checked::ApplyAccumulate<Op>(overflow, inputs[i]...);
+            return overflow;
+        }
+
+      public:
+        [[nodiscard]] static constexpr bool add(std::span<const T> a, std::span<const T> b, std::span<T> out) {return Run<detail::Checked::Add>(out, a, b);}
+        [[nodiscard]] static constexpr bool sub(std::span<const T> a, std::span<const T> b, std::span<T> out) {return Run<detail::Checked::Sub>(out, a, b);}
+        [[nodiscard]] static constexpr bool mul(std::span<const T> a, std::span<const T> b, std::span<T> out) {return Run<detail::Checked::Mul>(out, a, b);}
+        [[nodiscard]] static constexpr bool neg(std::span<const T> a, std::span<T> out) {return Run<detail::Checked::Neg>(out, a);}
+    };
 }
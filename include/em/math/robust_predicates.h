@@ -0,0 +1,415 @@
+#pragma once
+
+#include "em/macros/portable/if_consteval.h"
+#include "em/macros/utils/functors.h"
+#include "em/macros/utils/returns.h"
+#include "em/math/functions.h"
+#include "em/math/vector.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <concepts>
+#include <type_traits>
+
+// Exact geometric predicates: orientation and in-circle/in-sphere tests that always return the correct sign, based on Shewchuk's
+//   "Adaptive Precision Floating-Point Arithmetic and Fast Robust Geometric Predicates".
+// First the determinant is computed normally, and if its magnitude is larger than the error bound, its sign is returned right away.
+//   This is the common case. Otherwise it's recomputed exactly using the expansion arithmetic (representing numbers as unevaluated sums of doubles).
+// Everything is computed in `double`. `float` and integers up to 32 bits convert to it exactly, so they're supported too.
+// The results are exact as long as nothing overflows or underflows (roughly, the coordinates should stay in `[1e-70, 1e70]` in magnitude, or be zero).
+
+namespace em::Math::Robust
+{
+    // The coordinate types supported by the predicates below.
+    template <typename T>
+    concept predicate_scalar = std::is_same_v<T, float> || std::is_same_v<T, double> || (std::integral<T> && !std::is_same_v<T, bool> && sizeof(T) <= 4);
+
+    namespace detail::Predicates
+    {
+        // `(3 + 16 eps) eps` and so on, with `eps = 2^-53`. Those are the stage A bounds from the paper.
+        constexpr double epsilon = 0x1p-53;
+        constexpr double orient2d_bound = (3 + 16 * epsilon) * epsilon;
+        constexpr double orient3d_bound = (7 + 56 * epsilon) * epsilon;
+        constexpr double incircle_bound = (10 + 96 * epsilon) * epsilon;
+        constexpr double insphere_bound = (16 + 224 * epsilon) * epsilon;
+
+        [[nodiscard]] constexpr int Sign(double x)
+        {
+            return (x > 0) - (x < 0);
+        }
+
+        [[nodiscard]] constexpr double Abs(double x)
+        {
+            return x < 0 ? -x : x;
+        }
+
+        // `a + b` with no rounding, as the rounded sum and the error, when `abs(a) >= abs(b)`.
+        constexpr void FastTwoSum(double a, double b, double &sum, double &error)
+        {
+            sum = a + b;
+            error = b - (sum - a);
+        }
+
+        // Same, for any `a` and `b`.
+        constexpr void TwoSum(double a, double b, double &sum, double &error)
+        {
+            sum = a + b;
+            const double b_virtual = sum - a;
+            error = (a - (sum - b_virtual)) + (b - b_virtual);
+        }
+
+        // A sum of doubles that don't overlap bitwise, sorted by increasing magnitude, without zeroes. The zero has no terms.
+        // The capacity is fixed, so nothing is allocated.
+        template <int N>
+        struct Expansion
+        {
+            std::array<double, N> terms;
+            int size = 0;
+
+            constexpr void Push(double x)
+            {
+                if (x != 0)
+                    terms[std::size_t(size++)] = x;
+            }
+
+            // The largest term dominates the rest.
+            [[nodiscard]] constexpr int GetSign() const
+            {
+                return size == 0 ? 0 : Sign(terms[std::size_t(size - 1)]);
+            }
+
+            constexpr void Negate()
+            {
+                for (int i = 0; i < size; i++)
+                    terms[std::size_t(i)] = -terms[std::size_t(i)];
+            }
+
+            // Adds `f` to this. The capacity must be enough for the sum of the sizes.
+            // This is Shewchuk's "fast expansion sum": merges the terms by magnitude, and then adds them up in that order.
+            // This is done in place, without a second buffer: the old terms are moved to the end of the array, and the result is written from the beginning.
+            //   It never catches up with the unread old terms, since each step reads one term and writes at most one, and the capacity is enough for both.
+            template <int M>
+            constexpr void Add(const Expansion<M> &f)
+            {
+                if (f.size == 0)
+                    return;
+
+                const int e_size = size;
+                const int e_offset = N - e_size;
+                std::copy_backward(terms.begin(), terms.begin() + e_size, terms.end());
+                size = 0;
+
+                auto e = [&](int k) {return terms[std::size_t(e_offset + k)];};
+
+                int i = 0, j = 0;
+                auto next = [&]
+                {
+                    if (j == f.size || (i < e_size && (f.terms[std::size_t(j)] > e(i)) == (f.terms[std::size_t(j)] > -e(i))))
+                        return e(i++);
+                    else
+                        return f.terms[std::size_t(j++)];
+                };
+
+                double q = next();
+                while (i < e_size || j < f.size)
+                {
+                    double error;
+                    TwoSum(q, next(), q, error);
+                    Push(error);
+                }
+                Push(q);
+            }
+        };
+
+        [[nodiscard]] constexpr Expansion<2> Product(double a, double b)
+        {
+            double p, e;
+            Math::detail::Funcs::TwoProduct(a, b, p, e);
+            Expansion<2> ret;
+            ret.Push(e);
+            ret.Push(p);
+            return ret;
+        }
+
+        // Multiplies an expansion by a double.
+        template <int N>
+        [[nodiscard]] constexpr Expansion<N * 2> Scale(const Expansion<N> &e, double b)
+        {
+            Expansion<N * 2> ret;
+            if (e.size == 0)
+                return ret;
+
+            double q, error;
+            Math::detail::Funcs::TwoProduct(e.terms[0], b, q, error);
+            ret.Push(error);
+            for (int i = 1; i < e.size; i++)
+            {
+                double p_hi, p_lo, sum;
+                Math::detail::Funcs::TwoProduct(e.terms[std::size_t(i)], b, p_hi, p_lo);
+                TwoSum(q, p_lo, sum, error);
+                ret.Push(error);
+                FastTwoSum(p_hi, sum, q, error);
+                ret.Push(error);
+            }
+            ret.Push(q);
+            return ret;
+        }
+
+        template <int A, int B>
+        [[nodiscard]] constexpr Expansion<A * B * 2> Product(const Expansion<A> &a, const Expansion<B> &b)
+        {
+            Expansion<A * B * 2> ret;
+            for (int i = 0; i < b.size; i++)
+                ret.Add(Scale(a, b.terms[std::size_t(i)]));
+            return ret;
+        }
+
+        // `a.x * b.y - b.x * a.y`.
+        [[nodiscard]] constexpr Expansion<4> Cross(double ax, double ay, double bx, double by)
+        {
+            Expansion<4> ret;
+            ret.Add(Product(ax, by));
+            ret.Add(Product(-bx, ay));
+            return ret;
+        }
+
+        // The 3x3 determinant with the rows `(x, y, 1)`, which is `orient2d(a, b, c)`.
+        [[nodiscard]] constexpr Expansion<12> Det3(const dvec2 &a, const dvec2 &b, const dvec2 &c)
+        {
+            Expansion<12> ret;
+            ret.Add(Cross(a.x, a.y, b.x, b.y));
+            ret.Add(Cross(b.x, b.y, c.x, c.y));
+            ret.Add(Cross(c.x, c.y, a.x, a.y));
+            return ret;
+        }
+
+        // The 4x4 determinant with the rows `(x, y, z, 1)`, which is `orient3d(a, b, c, d)`. Expanded along the `z` column.
+        [[nodiscard]] constexpr Expansion<96> Det4(const dvec3 &a, const dvec3 &b, const dvec3 &c, const dvec3 &d)
+        {
+            Expansion<96> ret;
+            ret.Add(Scale(Det3(b.to_vec2(), c.to_vec2(), d.to_vec2()), a.z));
+            ret.Add(Scale(Det3(a.to_vec2(), c.to_vec2(), d.to_vec2()), -b.z));
+            ret.Add(Scale(Det3(a.to_vec2(), b.to_vec2(), d.to_vec2()), c.z));
+            ret.Add(Scale(Det3(a.to_vec2(), b.to_vec2(), c.to_vec2()), -d.z));
+            return ret;
+        }
+
+        // The squared length, exactly.
+        [[nodiscard]] constexpr Expansion<4> Lift(const dvec2 &a)
+        {
+            Expansion<4> ret;
+            ret.Add(Product(a.x, a.x));
+            ret.Add(Product(a.y, a.y));
+            return ret;
+        }
+        [[nodiscard]] constexpr Expansion<6> Lift(const dvec3 &a)
+        {
+            Expansion<6> ret;
+            ret.Add(Product(a.x, a.x));
+            ret.Add(Product(a.y, a.y));
+            ret.Add(Product(a.z, a.z));
+            return ret;
+        }
+
+        // The exact versions work directly on the coordinates instead of the differences, because the differences aren't exact,
+        //   and working with them would make the expansions longer.
+
+        [[nodiscard]] constexpr int Orient2dExact(const dvec2 &a, const dvec2 &b, const dvec2 &c)
+        {
+            return Det3(a, b, c).GetSign();
+        }
+
+        [[nodiscard]] constexpr int Orient3dExact(const dvec3 &a, const dvec3 &b, const dvec3 &c, const dvec3 &d)
+        {
+            return Det4(a, b, c, d).GetSign();
+        }
+
+        // The 4x4 determinant with the rows `(x, y, x^2 + y^2, 1)`, expanded along the third column.
+        [[nodiscard]] constexpr int IncircleExact(const dvec2 &a, const dvec2 &b, const dvec2 &c, const dvec2 &d)
+        {
+            Expansion<384> ret;
+            auto add = [&](const dvec2 &lifted, const dvec2 &p, const dvec2 &q, const dvec2 &r, bool negate)
+            {
+                Expansion<96> term = Product(Lift(lifted), Det3(p, q, r));
+                if (negate)
+                    term.Negate();
+                ret.Add(term);
+            };
+            add(a, b, c, d, false);
+            add(b, a, c, d, true);
+            add(c, a, b, d, false);
+            add(d, a, b, c, true);
+            return ret.GetSign();
+        }
+
+        // The 5x5 determinant with the rows `(x, y, z, x^2 + y^2 + z^2, 1)`, expanded along the fourth column.
+        [[nodiscard]] constexpr int InsphereExact(const dvec3 &a, const dvec3 &b, const dvec3 &c, const dvec3 &d, const dvec3 &e)
+        {
+            Expansion<5760> ret;
+            auto add = [&](const dvec3 &lifted, const dvec3 &p, const dvec3 &q, const dvec3 &r, const dvec3 &s, bool negate)
+            {
+                Expansion<1152> term = Product(Lift(lifted), Det4(p, q, r, s));
+                if (negate)
+                    term.Negate();
+                ret.Add(term);
+            };
+            add(a, b, c, d, e, true);
+            add(b, a, c, d, e, false);
+            add(c, a, b, d, e, true);
+            add(d, a, b, c, e, false);
+            add(e, a, b, c, d, true);
+            return ret.GetSign();
+        }
+
+        [[nodiscard]] constexpr int Orient2d(const dvec2 &a, const dvec2 &b, const dvec2 &c)
+        {
+            const double left = (a.x - c.x) * (b.y - c.y);
+            const double right = (a.y - c.y) * (b.x - c.x);
+            const double det = left - right;
+
+            // If the products have different signs, there's no cancellation, and the sign is right.
+            double permanent;
+            if (left > 0)
+            {
+                if (right <= 0)
+                    return Sign(det);
+                permanent = left + right;
+            }
+            else if (left < 0)
+            {
+                if (right >= 0)
+                    return Sign(det);
+                permanent = -left - right;
+            }
+            else
+            {
+                return Sign(det);
+            }
+
+            const double bound = orient2d_bound * permanent;
+            if (det >= bound || -det >= bound)
+                return Sign(det);
+            return Orient2dExact(a, b, c);
+        }
+
+        [[nodiscard]] constexpr int Orient3d(const dvec3 &a, const dvec3 &b, const dvec3 &c, const dvec3 &d)
+        {
+            const dvec3 ad = a - d, bd = b - d, cd = c - d;
+            const double bdx_cdy = bd.x * cd.y, cdx_bdy = cd.x * bd.y;
+            const double cdx_ady = cd.x * ad.y, adx_cdy = ad.x * cd.y;
+            const double adx_bdy = ad.x * bd.y, bdx_ady = bd.x * ad.y;
+
+            const double det = ad.z * (bdx_cdy - cdx_bdy) + bd.z * (cdx_ady - adx_cdy) + cd.z * (adx_bdy - bdx_ady);
+            const double permanent =
+                (Abs(bdx_cdy) + Abs(cdx_bdy)) * Abs(ad.z) +
+                (Abs(cdx_ady) + Abs(adx_cdy)) * Abs(bd.z) +
+                (Abs(adx_bdy) + Abs(bdx_ady)) * Abs(cd.z);
+
+            const double bound = orient3d_bound * permanent;
+            if (det > bound || -det > bound)
+                return Sign(det);
+            return Orient3dExact(a, b, c, d);
+        }
+
+        [[nodiscard]] constexpr int Incircle(const dvec2 &a, const dvec2 &b, const dvec2 &c, const dvec2 &d)
+        {
+            const dvec2 ad = a - d, bd = b - d, cd = c - d;
+            const double bdx_cdy = bd.x * cd.y, cdx_bdy = cd.x * bd.y;
+            const double cdx_ady = cd.x * ad.y, adx_cdy = ad.x * cd.y;
+            const double adx_bdy = ad.x * bd.y, bdx_ady = bd.x * ad.y;
+            const double a_lift = ad.x * ad.x + ad.y * ad.y;
+            const double b_lift = bd.x * bd.x + bd.y * bd.y;
+            const double c_lift = cd.x * cd.x + cd.y * cd.y;
+
+            const double det = a_lift * (bdx_cdy - cdx_bdy) + b_lift * (cdx_ady - adx_cdy) + c_lift * (adx_bdy - bdx_ady);
+            const double permanent =
+                (Abs(bdx_cdy) + Abs(cdx_bdy)) * a_lift +
+                (Abs(cdx_ady) + Abs(adx_cdy)) * b_lift +
+                (Abs(adx_bdy) + Abs(bdx_ady)) * c_lift;
+
+            const double bound = incircle_bound * permanent;
+            if (det > bound || -det > bound)
+                return Sign(det);
+            return IncircleExact(a, b, c, d);
+        }
+
+        [[nodiscard]] constexpr int Insphere(const dvec3 &a, const dvec3 &b, const dvec3 &c, const dvec3 &d, const dvec3 &e)
+        {
+            const dvec3 ae = a - e, be = b - e, ce = c - e, de = d - e;
+
+            const double aex_bey = ae.x * be.y, bex_aey = be.x * ae.y;
+            const double bex_cey = be.x * ce.y, cex_bey = ce.x * be.y;
+            const double cex_dey = ce.x * de.y, dex_cey = de.x * ce.y;
+            const double dex_aey = de.x * ae.y, aex_dey = ae.x * de.y;
+            const double aex_cey = ae.x * ce.y, cex_aey = ce.x * ae.y;
+            const double bex_dey = be.x * de.y, dex_bey = de.x * be.y;
+
+            const double ab = aex_bey - bex_aey;
+            const double bc = bex_cey - cex_bey;
+            const double cd = cex_dey - dex_cey;
+            const double da = dex_aey - aex_dey;
+            const double ac = aex_cey - cex_aey;
+            const double bd = bex_dey - dex_bey;
+
+            const double abc = ae.z * bc - be.z * ac + ce.z * ab;
+            const double bcd = be.z * cd - ce.z * bd + de.z * bc;
+            const double cda = ce.z * da + de.z * ac + ae.z * cd;
+            const double dab = de.z * ab + ae.z * bd + be.z * da;
+
+            const double a_lift = ae.x * ae.x + ae.y * ae.y + ae.z * ae.z;
+            const double b_lift = be.x * be.x + be.y * be.y + be.z * be.z;
+            const double c_lift = ce.x * ce.x + ce.y * ce.y + ce.z * ce.z;
+            const double d_lift = de.x * de.x + de.y * de.y + de.z * de.z;
+
+            const double det = (d_lift * abc - c_lift * dab) + (b_lift * cda - a_lift * bcd);
+
+            const double aez = Abs(ae.z), bez = Abs(be.z), cez = Abs(ce.z), dez = Abs(de.z);
+            const double ab_p = Abs(aex_bey) + Abs(bex_aey);
+            const double bc_p = Abs(bex_cey) + Abs(cex_bey);
+            const double cd_p = Abs(cex_dey) + Abs(dex_cey);
+            const double da_p = Abs(dex_aey) + Abs(aex_dey);
+            const double ac_p = Abs(aex_cey) + Abs(cex_aey);
+            const double bd_p = Abs(bex_dey) + Abs(dex_bey);
+            const double permanent =
+                (cd_p * bez + bd_p * cez + bc_p * dez) * a_lift +
+                (da_p * cez + ac_p * dez + cd_p * aez) * b_lift +
+                (ab_p * dez + bd_p * aez + da_p * bez) * c_lift +
+                (bc_p * aez + ac_p * bez + ab_p * cez) * d_lift;
+
+            const double bound = insphere_bound * permanent;
+            if (det > bound || -det > bound)
+                return Sign(det);
+            return InsphereExact(a, b, c, d, e);
+        }
+    }
+
+    // Those return `1`, `-1` or `0` (for degenerate cases), always exactly.
+
+    // Positive if `a`, `b`, `c` go counterclockwise (assuming Y points up), negative if clockwise, zero if they're collinear.
+    EM_SIMPLE_FUNCTOR( orient2d,
+        (template <predicate_scalar T>),
+        (const vec2<T> &a, const vec2<T> &b, const vec2<T> &c) EM_RETURNS(detail::Predicates::Orient2d(dvec2(a), dvec2(b), dvec2(c)))
+    )
+
+    // Positive if `d` is below the plane of `a`, `b`, `c`, where "above" is the side from which they look counterclockwise
+    //   (in a right-handed coordinate system). Negative if above, zero if all four are coplanar.
+    EM_SIMPLE_FUNCTOR( orient3d,
+        (template <predicate_scalar T>),
+        (const vec3<T> &a, const vec3<T> &b, const vec3<T> &c, const vec3<T> &d) EM_RETURNS(detail::Predicates::Orient3d(dvec3(a), dvec3(b), dvec3(c), dvec3(d)))
+    )
+
+    // Positive if `d` is inside the circle passing through `a`, `b`, `c`, negative if outside, zero if on it.
+    // The sign is flipped if `a`, `b`, `c` go clockwise, so `orient2d(a, b, c)` should be positive.
+    EM_SIMPLE_FUNCTOR( incircle,
+        (template <predicate_scalar T>),
+        (const vec2<T> &a, const vec2<T> &b, const vec2<T> &c, const vec2<T> &d) EM_RETURNS(detail::Predicates::Incircle(dvec2(a), dvec2(b), dvec2(c), dvec2(d)))
+    )
+
+    // Positive if `e` is inside the sphere passing through `a`, `b`, `c`, `d`, negative if outside, zero if on it.
+    // The sign is flipped if `orient3d(a, b, c, d)` is negative, so it should be positive.
+    EM_SIMPLE_FUNCTOR( insphere,
+        (template <predicate_scalar T>),
+        (const vec3<T> &a, const vec3<T> &b, const vec3<T> &c, const vec3<T> &d, const vec3<T> &e) EM_RETURNS(detail::Predicates::Insphere(dvec3(a), dvec3(b), dvec3(c), dvec3(d), dvec3(e)))
+    )
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include "em/math/larger_type.h"
+#include "em/math/min_max.h"
+#include "em/math/namespaces.h"
+#include "em/math/parallel.h"
+#include "em/math/vector.h"
+#include "em/math/vector_traits.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// Single-pass statistics of a stream of scalars or vectors: the mean, the variance, the covariance matrix, the min and the max.
+
+namespace em::Math
+{
+    namespace detail::RunningStats
+    {
+        // Stored instead of the covariance matrix when it's disabled.
+        struct NoCovariance {};
+
+        // The covariance matrix type for the mean type `A`.
+        template <typename A> struct Matrix {using type = NoCovariance;};
+        template <vector A> struct Matrix<A> {using type = vec<vec<vec_base_t<A>, vec_size<A>>, vec_size<A>>;};
+
+        // The initial values of the min and the max. Those are infinities for floating-point types, otherwise infinite samples wouldn't be handled.
+        template <typename T> constexpr T InitialMin = std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+        template <typename T> constexpr T InitialMax = std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest();
+    }
+
+    // Accumulates the statistics one sample at a time using Welford's algorithm, which doesn't lose precision the way `sum(x^2) - sum(x)^2` does.
+    // Two accumulators can be merged (using the formulas from Chan et al.), so the threads can process parts of the stream separately.
+    // `A` is the type used for the mean and the variance. By default this is `double` or a vector of `double`s, picked with `larger_t`.
+    // If `Covariance` is true, also computes the full covariance matrix. Only for vectors, and there's no matrix type yet,
+    //   so it's `vecN<vecN<...>>` holding the columns.
+    template <vector_or_scalar T, bool Covariance = false, floating_point_vector_or_scalar A = larger_t<T, double>>
+    requires(vec_size<T> == vec_size<A> && (!Covariance || vector<T>))
+    class running_stats
+    {
+      public:
+        using sample_type = T;
+        using value_type = A;
+        using real_type = vec_base_t<A>;
+        using matrix_type = typename detail::RunningStats::Matrix<A>::type;
+
+        // `push(span)` splits the samples into blocks of this size, computes the stats of each block with two simple passes, and then merges them.
+        // This is faster than pushing them one by one, because there's no division per sample and the loops vectorize.
+        static constexpr std::size_t block_size = 256;
+        // Inputs with less than this many samples per thread use fewer threads.
+        static constexpr std::size_t min_samples_per_thread = 1 << 14;
+
+      private:
+        std::size_t num_samples = 0;
+        A mean_value{};
+        // The sum of squared differences from the mean.
+        A sum_sq_diff{};
+        // The sum of products of differences from the mean, for each pair of components.
+        [[no_unique_address]] std::conditional_t<Covariance, matrix_type, detail::RunningStats::NoCovariance> sum_prod_diff{};
+        T min_value = T(detail::RunningStats::InitialMin<vec_base_t<T>>);
+        T max_value = T(detail::RunningStats::InitialMax<vec_base_t<T>>);
+
+        // The matrix with the element in row `i` and column `j` equal to `a[i] * b[j]`.
+        [[nodiscard]] static constexpr matrix_type OuterProduct(const A &a, const A &b)
+        {
+            matrix_type ret;
+            for (int j = 0; j < vec_size<A>; j++)
+                ret[j] = a * b[j];
+            return ret;
+        }
+
+        // Computes the stats of a small block of samples in two passes: the mean first, and then the differences from it.
+        [[nodiscard]] static constexpr running_stats FromBlock(std::span<const T> samples)
+        {
+            running_stats ret;
+            ret.num_samples = samples.size();
+            if (samples.empty())
+                return ret;
+
+            A sum{};
+            for (const T &x : samples)
+            {
+                sum += A(x);
+                ret.min_value = Math::min(ret.min_value, x);
+                ret.max_value = Math::max(ret.max_value, x);
+            }
+            ret.mean_value = sum / real_type(samples.size());
+
+            for (const T &x : samples)
+            {
+                const A diff = A(x) - ret.mean_value;
+                ret.sum_sq_diff += diff * diff;
+                if constexpr (Covariance)
+                    ret.sum_prod_diff += OuterProduct(diff, diff);
+            }
+            return ret;
+        }
+
+      public:
+        constexpr running_stats() {}
+
+        // Adds a sample.
+        constexpr void push(const T &sample)
+        {
+            num_samples++;
+            const A x(sample);
+            const A diff_before = x - mean_value;
+            mean_value += diff_before / real_type(num_samples);
+            const A diff_after = x - mean_value;
+            sum_sq_diff += diff_before * diff_after;
+            if constexpr (Covariance)
+                sum_prod_diff += OuterProduct(diff_before, diff_after);
+            min_value = Math::min(min_value, sample);
+            max_value = Math::max(max_value, sample);
+        }
+
+        // Adds many samples. The result is the same as pushing them one by one, up to rounding (it's usually a bit more accurate).
+        // `num_threads == 0` means `std::thread::hardware_concurrency()`.
+        // The stats of the blocks are merged in the block order, so the result doesn't depend on the number of threads.
+        constexpr void push(std::span<const T> samples, int num_threads = 0)
+        {
+            const std::size_t num_blocks = (samples.size() + block_size - 1) / block_size;
+            std::vector<running_stats> block_stats;
+            block_stats.resize(num_blocks);
+
+            parallel_for(num_blocks, num_threads, min_samples_per_thread / block_size, [&](int, std::size_t begin_block, std::size_t end_block)
+            {
+                for (std::size_t i = begin_block; i < end_block; i++)
+                {
+                    const std::size_t begin = i * block_size;
+                    block_stats[i] = FromBlock(samples.subspan(begin, std::min(block_size, samples.size() - begin)));
+                }
+            });
+
+            running_stats all;
+            for (const running_stats &block : block_stats)
+                all.merge(block);
+            merge(all);
+        }
+
+        // Adds all samples from `other` to this accumulator.
+        constexpr void merge(const running_stats &other)
+        {
+            if (other.num_samples == 0)
+                return;
+            if (num_samples == 0)
+            {
+                *this = other;
+                return;
+            }
+
+            const std::size_t total = num_samples + other.num_samples;
+            const real_type other_fraction = real_type(other.num_samples) / real_type(total);
+            const real_type weight = real_type(num_samples) * other_fraction;
+
+            const A diff = other.mean_value - mean_value;
+            mean_value += diff * other_fraction;
+            sum_sq_diff += other.sum_sq_diff + diff * diff * weight;
+            if constexpr (Covariance)
+                sum_prod_diff += other.sum_prod_diff + OuterProduct(diff, diff) * weight;
+            min_value = Math::min(min_value, other.min_value);
+            max_value = Math::max(max_value, other.max_value);
+            num_samples = total;
+        }
+
+        // The number of samples.
+        [[nodiscard]] constexpr std::size_t count() const {return num_samples;}
+
+        // Zero if there are no samples.
+        [[nodiscard]] constexpr const A &mean() const {return mean_value;}
+
+        // The population variance (divided by `n`), for each component separately. NaN if there are no samples.
+        [[nodiscard]] constexpr A variance() const {return sum_sq_diff / real_type(num_samples);}
+        // The sample variance (divided by `n - 1`), for each component separately. Meaningless if there's less than 2 samples.
+        [[nodiscard]] constexpr A sample_variance() const {return sum_sq_diff / (real_type(num_samples) - 1);}
+
+        // The population covariance matrix (divided by `n`), as columns. The diagonal is the same as `variance()`.
+        [[nodiscard]] constexpr matrix_type covariance() const requires Covariance {return sum_prod_diff / real_type(num_samples);}
+        // The sample covariance matrix (divided by `n - 1`), as columns. The diagonal is the same as `sample_variance()`.
+        [[nodiscard]] constexpr matrix_type sample_covariance() const requires Covariance {return sum_prod_diff / (real_type(num_samples) - 1);}
+
+        // The smallest and the largest values of each component. If there are no samples, `min() > max()`.
+        [[nodiscard]] constexpr const T &min() const {return min_value;}
+        [[nodiscard]] constexpr const T &max() const {return max_value;}
+    };
+
+    inline namespace Common
+    {
+        using Math::running_stats;
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "em/math/functions.h"
+#include "em/math/namespaces.h"
+#include "em/math/parallel.h"
+#include "em/math/scalar.h"
+#include "em/math/vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+
+// Linear blend skinning: moving the mesh vertices with the bones, each vertex being attached to up to 4 bones with different weights.
+
+namespace em::Math
+{
+    // Skins vertex buffers on the CPU.
+    // There's no matrix type yet, so each bone transform is an affine 3x4 matrix stored as `vec4<vec3<T>>` columns, with `w` being the translation.
+    // A vertex is moved by the weighted sum of its bone matrices. The weights should add up to 1, unused slots should have zero weights (any valid index).
+    // The normals are transformed by the same matrices without the translation, and aren't renormalized.
+    //   This is only correct if the bones have no non-uniform scale.
+    template <floating_point_scalar T = float>
+    struct linear_blend_skinning
+    {
+        using bone_type = vec4<vec3<T>>;
+
+        // Meshes with less than this many vertices per thread use fewer threads.
+        static constexpr std::size_t min_vertices_per_thread = 1 << 12;
+        // This many vertices are handled per loop iteration. Their matrices are blended first, and then applied, to keep more independent loads in flight.
+        static constexpr std::size_t vertices_per_iteration = 4;
+
+      private:
+        // `sum + bone * weight`, for all columns.
+        [[nodiscard]] static constexpr bone_type AddWeighted(const bone_type &sum, const bone_type &bone, T weight)
+        {
+            const vec3<T> w(weight);
+            return bone_type(fma(bone.x, w, sum.x), fma(bone.y, w, sum.y), fma(bone.z, w, sum.z), fma(bone.w, w, sum.w));
+        }
+
+        template <typename I>
+        static constexpr void Apply(
+            std::span<const bone_type> bones, std::span<const vec4<I>> bone_indices, std::span<const vec4<T>> weights,
+            std::span<const vec3<T>> positions, std::span<const vec3<T>> normals,
+            std::span<vec3<T>> out_positions, std::span<vec3<T>> out_normals,
+            int num_threads
+        )
+        {
+            const std::size_t n = positions.size();
+            if (bone_indices.size() != n || weights.size() != n)
+                throw std::length_error("The number of bone indices and weights must match the number of vertices.");
+            if (!normals.empty() && normals.size() != n)
+                throw std::length_error("The number of normals must match the number of vertices, or be zero.");
+            if (out_positions.size() < n || out_normals.size() < normals.size())
+                throw std::length_error("The output span for skinning is too small.");
+
+            parallel_for(n, num_threads, min_vertices_per_thread, [&](int, std::size_t begin, std::size_t end)
+            {
+                bone_type m[vertices_per_iteration];
+
+                for (std::size_t i = begin; i < end; i += vertices_per_iteration)
+                {
+                    const std::size_t count = std::min(vertices_per_iteration, end - i);
+
+                    for (std::size_t j = 0; j < count; j++)
+                    {
+                        const vec4<I> &index = bone_indices[i + j];
+                        const vec4<T> &weight = weights[i + j];
+                        // One check per vertex instead of four.
+                        if (std::size_t(std::max(std::max(index.x, index.y), std::max(index.z, index.w))) >= bones.size())
+                            throw std::out_of_range("A bone index for skinning is out of range.");
+
+                        const bone_type &b0 = bones[index.x];
+                        m[j] = bone_type(b0.x * weight.x, b0.y * weight.x, b0.z * weight.x, b0.w * weight.x);
+                        m[j] = AddWeighted(m[j], bones[index.y], weight.y);
+                        m[j] = AddWeighted(m[j], bones[index.z], weight.z);
+                        m[j] = AddWeighted(m[j], bones[index.w], weight.w);
+                    }
+
+                    for (std::size_t j = 0; j < count; j++)
+                    {
+                        const vec3<T> p = positions[i + j];
+                        out_positions[i + j] = fma(m[j].x, vec3<T>(p.x), fma(m[j].y, vec3<T>(p.y), fma(m[j].z, vec3<T>(p.z), m[j].w)));
+                    }
+
+                    if (!normals.empty())
+                    {
+                        for (std::size_t j = 0; j < count; j++)
+                        {
+                            const vec3<T> p = normals[i + j];
+                            out_normals[i + j] = fma(m[j].x, vec3<T>(p.x), fma(m[j].y, vec3<T>(p.y), m[j].z * p.z));
+                        }
+                    }
+                }
+            });
+        }
+
+      public:
+        // Skins the vertices. `normals` and `out_normals` can be empty to skip the normals.
+        // The outputs can be the same as the inputs. `num_threads == 0` means `std::thread::hardware_concurrency()`.
+        // Throws if a bone index is out of range, possibly after writing a part of the output.
+        static constexpr void apply(
+            std::span<const bone_type> bones, std::span<const vec4<std::uint8_t>> bone_indices, std::span<const vec4<T>> weights,
+            std::span<const vec3<T>> positions, std::span<const vec3<T>> normals,
+            std::span<vec3<T>> out_positions, std::span<vec3<T>> out_normals,
+            int num_threads = 0
+        )
+        {
+            Apply(bones, bone_indices, weights, positions, normals, out_positions, out_normals, num_threads);
+        }
+        static constexpr void apply(
+            std::span<const bone_type> bones, std::span<const vec4<std::uint16_t>> bone_indices, std::span<const vec4<T>> weights,
+            std::span<const vec3<T>> positions, std::span<const vec3<T>> normals,
+            std::span<vec3<T>> out_positions, std::span<vec3<T>> out_normals,
+            int num_threads = 0
+        )
+        {
+            Apply(bones, bone_indices, weights, positions, normals, out_positions, out_normals, num_threads);
+        }
+    };
+
+    inline namespace Common
+    {
+        using Math::linear_blend_skinning;
+    }
+}
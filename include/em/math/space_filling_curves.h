@@ -0,0 +1,321 @@
+#pragma once
+
+#include "em/macros/portable/if_consteval.h"
+#include "em/macros/portable/tiny_func.h"
+#include "em/math/namespaces.h"
+#include "em/math/robust.h"
+#include "em/math/scalar.h"
+#include "em/math/vector.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+// Morton (Z-order) and Hilbert indices for 2D and 3D integer vectors.
+// Sorting points by those, or laying out grids in this order, keeps the nearby points close in memory.
+//
+// 2D vectors use 32 bits per component, and 3D vectors use 21 bits per component, so the indices always fit into 64 bits.
+// The extra high bits of the components are ignored, and negative components are treated as their unsigned equivalents.
+// Use the `..._checked` functions to throw on those instead.
+
+#if (defined(__x86_64__) || defined(_M_X64)) && defined(__BMI2__)
+#include <immintrin.h>
+#define DETAIL_EM_SFC_BMI2 1
+#else
+#define DETAIL_EM_SFC_BMI2 0
+#endif
+
+namespace em::Math
+{
+    // The vectors we can encode.
+    template <typename T>
+    concept space_filling_curve_vector = vector<T> && (vec_size<T> == 2 || vec_size<T> == 3) && integral_scalar<vec_base_t<T>> && !std::is_same_v<vec_base_t<T>, bool>;
+
+    // The number of bits per component used by the encoding functions.
+    template <int N> requires (N == 2 || N == 3)
+    inline constexpr int space_filling_curve_bits = N == 2 ? 32 : 21;
+
+    namespace detail::SpaceFilling
+    {
+        // Which bits of a Morton code belong to the component `i`.
+        template <int N>
+        [[nodiscard]] EM_TINY constexpr std::uint64_t AxisMask(int i) noexcept
+        {
+            return (N == 2 ? 0x5555555555555555 : 0x1249249249249249) << i;
+        }
+
+        // Inserts zero bits between the bits of `x`: one bit for `N == 2`, two bits for `N == 3`.
+        template <int N>
+        [[nodiscard]] EM_TINY constexpr std::uint64_t Spread(std::uint64_t x) noexcept
+        {
+            if constexpr (N == 2)
+            {
+                x &= 0xffffffff;
+                x = (x | x << 16) & 0x0000ffff0000ffff;
+                x = (x | x << 8) & 0x00ff00ff00ff00ff;
+                x = (x | x << 4) & 0x0f0f0f0f0f0f0f0f;
+                x = (x | x << 2) & 0x3333333333333333;
+                x = (x | x << 1) & 0x5555555555555555;
+            }
+            else
+            {
+                x &= 0x1fffff;
+                x = (x | x << 32) & 0x001f00000000ffff;
+                x = (x | x << 16) & 0x001f0000ff0000ff;
+                x = (x | x << 8) & 0x100f00f00f00f00f;
+                x = (x | x << 4) & 0x10c30c30c30c30c3;
+                x = (x | x << 2) & 0x1249249249249249;
+            }
+            return x;
+        }
+
+        // The inverse of `Spread()`.
+        template <int N>
+        [[nodiscard]] EM_TINY constexpr std::uint32_t Compact(std::uint64_t x) noexcept
+        {
+            if constexpr (N == 2)
+            {
+                x &= 0x5555555555555555;
+                x = (x | x >> 1) & 0x3333333333333333;
+                x = (x | x >> 2) & 0x0f0f0f0f0f0f0f0f;
+                x = (x | x >> 4) & 0x00ff00ff00ff00ff;
+                x = (x | x >> 8) & 0x0000ffff0000ffff;
+                x = (x | x >> 16) & 0xffffffff;
+            }
+            else
+            {
+                x &= 0x1249249249249249;
+                x = (x | x >> 2) & 0x10c30c30c30c30c3;
+                x = (x | x >> 4) & 0x100f00f00f00f00f;
+                x = (x | x >> 8) & 0x001f0000ff0000ff;
+                x = (x | x >> 16) & 0x001f00000000ffff;
+                x = (x | x >> 32) & 0x1fffff;
+            }
+            return std::uint32_t(x);
+        }
+
+        // Interleaves the bits of the components, X goes to the lowest bit.
+        template <int N>
+        [[nodiscard]] EM_TINY constexpr std::uint64_t Interleave(const vec<std::uint32_t, N> &v) noexcept
+        {
+            #if DETAIL_EM_SFC_BMI2
+            EM_IF_CONSTEVAL {} else
+            {
+                std::uint64_t ret = 0;
+                for (int i = 0; i < N; i++)
+                    ret |= _pdep_u64(v[i], AxisMask<N>(i));
+                return ret;
+            }
+            #endif
+
+            std::uint64_t ret = 0;
+            for (int i = 0; i < N; i++)
+                ret |= Spread<N>(v[i]) << i;
+            return ret;
+        }
+
+        // The inverse of `Interleave()`.
+        template <int N>
+        [[nodiscard]] EM_TINY constexpr vec<std::uint32_t, N> Deinterleave(std::uint64_t code) noexcept
+        {
+            vec<std::uint32_t, N> ret;
+
+            #if DETAIL_EM_SFC_BMI2
+            EM_IF_CONSTEVAL {} else
+            {
+                for (int i = 0; i < N; i++)
+                    ret[i] = std::uint32_t(_pext_u64(code, AxisMask<N>(i)));
+                return ret;
+            }
+            #endif
+
+            for (int i = 0; i < N; i++)
+                ret[i] = Compact<N>(code >> i);
+            return ret;
+        }
+
+        // Hilbert indices use Skilling's algorithm ("Programming the Hilbert curve", 2004),
+        //   which converts the coordinates to the "transposed" Hilbert index, where the bits are then interleaved as in the Morton code.
+
+        template <int N>
+        [[nodiscard]] constexpr std::uint64_t HilbertEncode(vec<std::uint32_t, N> x) noexcept
+        {
+            constexpr int bits = space_filling_curve_bits<N>;
+            if constexpr (bits < 32)
+                x &= (std::uint32_t(1) << bits) - 1;
+
+            // Inverse undo.
+            for (std::uint32_t q = std::uint32_t(1) << (bits - 1); q > 1; q >>= 1)
+            {
+                const std::uint32_t p = q - 1;
+                for (int i = 0; i < N; i++)
+                {
+                    if (x[i] & q)
+                    {
+                        x[0] ^= p;
+                    }
+                    else
+                    {
+                        std::uint32_t t = (x[0] ^ x[i]) & p;
+                        x[0] ^= t;
+                        x[i] ^= t;
+                    }
+                }
+            }
+
+            // Gray encode.
+            for (int i = 1; i < N; i++)
+                x[i] ^= x[i - 1];
+            std::uint32_t t = 0;
+            for (std::uint32_t q = std::uint32_t(1) << (bits - 1); q > 1; q >>= 1)
+            {
+                if (x[N - 1] & q)
+                    t ^= q - 1;
+            }
+            x ^= t;
+
+            // The first component has the most significant bit of each group.
+            vec<std::uint32_t, N> reversed;
+            for (int i = 0; i < N; i++)
+                reversed[i] = x[N - 1 - i];
+            return Interleave(reversed);
+        }
+
+        template <int N>
+        [[nodiscard]] constexpr vec<std::uint32_t, N> HilbertDecode(std::uint64_t code) noexcept
+        {
+            constexpr int bits = space_filling_curve_bits<N>;
+
+            const vec<std::uint32_t, N> reversed = Deinterleave<N>(code);
+            vec<std::uint32_t, N> x;
+            for (int i = 0; i < N; i++)
+                x[i] = reversed[N - 1 - i];
+
+            // Gray decode.
+            std::uint32_t t = x[N - 1] >> 1;
+            for (int i = N - 1; i > 0; i--)
+                x[i] ^= x[i - 1];
+            x[0] ^= t;
+
+            // Undo the excess work. This is 64-bit, because the last `q` doesn't fit into 32 bits.
+            for (std::uint64_t q = 2; q != std::uint64_t(1) << bits; q <<= 1)
+            {
+                const std::uint32_t p = std::uint32_t(q - 1);
+                for (int i = N - 1; i >= 0; i--)
+                {
+                    if (x[i] & q)
+                    {
+                        x[0] ^= p;
+                    }
+                    else
+                    {
+                        std::uint32_t t2 = (x[0] ^ x[i]) & p;
+                        x[0] ^= t2;
+                        x[i] ^= t2;
+                    }
+                }
+            }
+            return x;
+        }
+    }
+
+    // Returns true if the vector fits into `space_filling_curve_bits` bits per component, and has no negative components.
+    struct FnSpaceFillingCurveInRange
+    {
+        template <space_filling_curve_vector V>
+        [[nodiscard]] static constexpr bool operator()(const V &v) noexcept
+        {
+            constexpr std::uint64_t max_value = (std::uint64_t(1) << space_filling_curve_bits<vec_size<V>>) - 1;
+            for (int i = 0; i < vec_size<V>; i++)
+            {
+                if (Robust::less(v[i], 0) || Robust::greater(v[i], max_value))
+                    return false;
+            }
+            return true;
+        }
+    };
+    inline constexpr FnSpaceFillingCurveInRange space_filling_curve_in_range;
+
+    // Morton codes (`Hilbert == false`) and Hilbert indices (`Hilbert == true`).
+    template <bool Hilbert>
+    struct FnSpaceFillingCurveEncode
+    {
+        template <space_filling_curve_vector V>
+        [[nodiscard]] static constexpr std::uint64_t operator()(const V &v) noexcept
+        {
+            if constexpr (Hilbert)
+                return detail::SpaceFilling::HilbertEncode(v.template to<std::uint32_t>());
+            else
+                return detail::SpaceFilling::Interleave(v.template to<std::uint32_t>());
+        }
+
+        // Encodes every element of `in`.
+        template <space_filling_curve_vector V>
+        static constexpr void operator()(std::span<const V> in, std::span<std::uint64_t> out)
+        {
+            if (out.size() < in.size())
+                throw std::length_error("The output span is smaller than the input span.");
+            for (std::size_t i = 0; i < in.size(); i++)
+                out[i] = operator()(in[i]);
+        }
+    };
+    template <bool Hilbert>
+    struct FnSpaceFillingCurveEncodeChecked
+    {
+        template <space_filling_curve_vector V>
+        [[nodiscard]] static constexpr std::uint64_t operator()(const V &v)
+        {
+            if (!space_filling_curve_in_range(v))
+                throw std::runtime_error("The coordinates are out of range for the space-filling curve.");
+            return FnSpaceFillingCurveEncode<Hilbert>{}(v);
+        }
+    };
+    template <space_filling_curve_vector V, bool Hilbert>
+    struct FnSpaceFillingCurveDecode
+    {
+        [[nodiscard]] static constexpr V operator()(std::uint64_t code) noexcept
+        {
+            if constexpr (Hilbert)
+                return V(detail::SpaceFilling::HilbertDecode<vec_size<V>>(code));
+            else
+                return V(detail::SpaceFilling::Deinterleave<vec_size<V>>(code));
+        }
+
+        // Decodes every element of `in`.
+        static constexpr void operator()(std::span<const std::uint64_t> in, std::span<V> out)
+        {
+            if (out.size() < in.size())
+                throw std::length_error("The output span is smaller than the input span.");
+            for (std::size_t i = 0; i < in.size(); i++)
+                out[i] = operator()(in[i]);
+        }
+    };
+
+    // Interleaves the bits of the components, X goes to the lowest bit.
+    inline constexpr FnSpaceFillingCurveEncode<false> morton_encode;
+    // Returns the index of the point along the Hilbert curve. Better locality than the Morton order, but slower to compute.
+    // The curve starts at the origin, so the first `2^(N*k)` indices cover the cube of size `2^k` at the origin.
+    inline constexpr FnSpaceFillingCurveEncode<true> hilbert_encode;
+
+    // Same, but throw if `space_filling_curve_in_range()` is false.
+    inline constexpr FnSpaceFillingCurveEncodeChecked<false> morton_encode_checked;
+    inline constexpr FnSpaceFillingCurveEncodeChecked<true> hilbert_encode_checked;
+
+    // The inverse functions. Usage: `morton_decode<ivec2>(code)`.
+    // If `V` is signed, the 2D components that don't fit into it wrap around.
+    template <space_filling_curve_vector V> inline constexpr FnSpaceFillingCurveDecode<V, false> morton_decode;
+    template <space_filling_curve_vector V> inline constexpr FnSpaceFillingCurveDecode<V, true> hilbert_decode;
+
+    inline namespace Common
+    {
+        using Math::morton_encode;
+        using Math::morton_encode_checked;
+        using Math::morton_decode;
+        using Math::hilbert_encode;
+        using Math::hilbert_encode_checked;
+        using Math::hilbert_decode;
+        using Math::space_filling_curve_in_range;
+    }
+}
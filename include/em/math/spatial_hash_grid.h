@@ -0,0 +1,197 @@
+#pragma once
+
+#include "em/math/functions.h"
+#include "em/math/namespaces.h"
+#include "em/math/parallel.h"
+#include "em/math/radix_sort.h"
+#include "em/math/rect.h"
+#include "em/math/scalar.h"
+#include "em/math/vector.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// A uniform grid stored as a hash table of cells, for finding the neighbors of many moving points. Meant to be rebuilt from scratch every tick.
+
+namespace em::Math
+{
+    // Splits the space into cells of size `cell_size()`, and hashes the cells into buckets, so the grid is unbounded and doesn't depend on the point distribution.
+    // The points are sorted by bucket, so each bucket is a contiguous range, and nothing is allocated per cell.
+    // `T` can be integral, then the cells are computed with `div_ex()`, otherwise with `ifloor()`. Either way the negative coordinates work.
+    // Holds on to its memory, so rebuilding doesn't allocate.
+    // The number of points is limited to `2^32 - 1`, and the cell coordinates must fit into `int`.
+    template <scalar T, int N = 3> requires(N == 2 || N == 3)
+    class spatial_hash_grid
+    {
+      public:
+        using type = T;
+        static constexpr int dims = N;
+        using point_type = vec<T, N>;
+        using cell_type = vec<int, N>;
+
+        // Inputs with less than this many points per thread use fewer threads.
+        static constexpr std::size_t min_elements_per_thread = 1 << 14;
+
+      private:
+        T cell_len = 1;
+        // `1 / cell_len`, for floating-point `T`.
+        T inv_cell_len = 1;
+        // There are `2^bucket_bits` buckets, about one per point.
+        int bucket_bits = 1;
+
+        // The bucket `i` is `[bucket_starts[i], bucket_starts[i + 1])` in `entries`. This has one extra element at the end.
+        std::vector<std::uint32_t> bucket_starts;
+        // The point indices, sorted by bucket.
+        std::vector<std::uint32_t> entries;
+        // The cells of `entries`, to tell apart the different cells in the same bucket.
+        std::vector<cell_type> entry_cells;
+
+        // Only used while building.
+        std::vector<cell_type> point_cells;
+        std::vector<std::uint32_t> point_buckets;
+        radix_sorter<std::uint32_t> sorter;
+
+        [[nodiscard]] constexpr std::uint32_t BucketOf(const cell_type &cell) const
+        {
+            std::uint32_t h = std::uint32_t(cell.x) * 73856093u ^ std::uint32_t(cell.y) * 19349663u;
+            if constexpr (N == 3)
+                h ^= std::uint32_t(cell.z) * 83492791u;
+            // Fibonacci hashing, because the top bits of the product are well mixed.
+            return std::uint32_t(h * 0x9e3779b1u) >> (32 - bucket_bits);
+        }
+
+      public:
+        constexpr spatial_hash_grid() {}
+        constexpr explicit spatial_hash_grid(T cell_size)
+            : cell_len(cell_size)
+        {
+            if (!(cell_size > 0))
+                throw std::runtime_error("The cell size of a spatial hash grid must be positive.");
+            if constexpr (std::is_floating_point_v<T>)
+                inv_cell_len = 1 / cell_size;
+        }
+
+        [[nodiscard]] constexpr T cell_size() const {return cell_len;}
+
+        // The cell containing the point.
+        [[nodiscard]] constexpr cell_type cell_of(const point_type &point) const
+        {
+            if constexpr (std::is_floating_point_v<T>)
+                return ifloor(point * inv_cell_len);
+            else
+                return div_ex(point, cell_len).template to<int>();
+        }
+
+        // The point indices sorted by bucket, and their cells. Mostly useful for iterating over all points in a cache-friendly order.
+        [[nodiscard]] constexpr std::span<const std::uint32_t> indices() const {return entries;}
+        [[nodiscard]] constexpr std::span<const cell_type> cells() const {return entry_cells;}
+        // The number of points.
+        [[nodiscard]] constexpr std::size_t size() const {return entries.size();}
+        [[nodiscard]] constexpr bool empty() const {return entries.empty();}
+
+        // Frees the memory.
+        constexpr void clear()
+        {
+            bucket_starts = {};
+            entries = {};
+            entry_cells = {};
+            point_cells = {};
+            point_buckets = {};
+            sorter.release();
+        }
+
+        // Puts the points into the grid, replacing the old contents. `num_threads == 0` means `std::thread::hardware_concurrency()`.
+        constexpr void build(std::span<const point_type> points, int num_threads = 0)
+        {
+            if (points.size() > std::numeric_limits<std::uint32_t>::max())
+                throw std::length_error("Too many points for the spatial hash grid.");
+
+            const std::size_t n = points.size();
+            bucket_bits = std::clamp(int(std::bit_width(n)), 1, 30);
+            const std::size_t num_buckets = std::size_t(1) << bucket_bits;
+
+            point_cells.resize(n);
+            point_buckets.resize(n);
+            entries.resize(n);
+            entry_cells.resize(n);
+            bucket_starts.resize(num_buckets + 1);
+
+            parallel_for(n, num_threads, min_elements_per_thread, [&](int, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; i++)
+                {
+                    point_cells[i] = cell_of(points[i]);
+                    point_buckets[i] = BucketOf(point_cells[i]);
+                }
+            });
+
+            // The radix sort is a counting sort per byte, and skips the bytes that are zero in all bucket indices.
+            sorter.sort_permutation(point_buckets, entries, num_threads);
+
+            if (n == 0)
+            {
+                std::fill(bucket_starts.begin(), bucket_starts.end(), std::uint32_t(0));
+                return;
+            }
+
+            parallel_for(n, num_threads, min_elements_per_thread, [&](int, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; i++)
+                {
+                    entry_cells[i] = point_cells[entries[i]];
+
+                    // Every bucket between the previous entry and this one (including this one) starts here. This writes each bucket exactly once.
+                    const std::size_t first_bucket = i == 0 ? 0 : point_buckets[entries[i - 1]] + std::size_t(1);
+                    const std::size_t last_bucket = point_buckets[entries[i]];
+                    for (std::size_t b = first_bucket; b <= last_bucket; b++)
+                        bucket_starts[b] = std::uint32_t(i);
+                }
+
+                if (end == n)
+                {
+                    for (std::size_t b = point_buckets[entries[n - 1]] + std::size_t(1); b <= num_buckets; b++)
+                        bucket_starts[b] = std::uint32_t(n);
+                }
+            });
+        }
+
+        // Calls `func(index)` for every point in the cell.
+        constexpr void for_each_in_cell(const cell_type &cell, auto &&func) const
+        {
+            if (entries.empty())
+                return;
+
+            const std::uint32_t bucket = BucketOf(cell);
+            for (std::uint32_t i = bucket_starts[bucket]; i < bucket_starts[bucket + 1]; i++)
+            {
+                if (entry_cells[i] == cell)
+                    func(entries[i]);
+            }
+        }
+
+        // Calls `func(index)` for every point in the cell and the cells around it (`3^N` cells in total).
+        constexpr void for_each_in_neighborhood(const cell_type &cell, auto &&func) const
+        {
+            for (const cell_type &c : rect<int, N>(cell - 1, cell + 2))
+                for_each_in_cell(c, func);
+        }
+
+        // Calls `func(index)` for the points around `point`. If the cell size is at least `r`, this visits all points at the distance up to `r`, and some farther ones.
+        constexpr void for_each_near(const point_type &point, auto &&func) const
+        {
+            for_each_in_neighborhood(cell_of(point), func);
+        }
+    };
+
+    inline namespace Common
+    {
+        using Math::spatial_hash_grid;
+    }
+}
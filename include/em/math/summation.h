@@ -0,0 +1,203 @@
+#pragma once
+
+#include "em/math/functions.h"
+#include "em/math/namespaces.h"
+#include "em/math/parallel.h"
+#include "em/math/vector.h"
+#include "em/math/vector_traits.h"
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+// Summation of long sequences of floating-point numbers and vectors, with less rounding error than a plain loop.
+// This is all pointless with `-ffast-math` (or rather `-fassociative-math`), which lets the compiler optimize the compensation away.
+
+namespace em::Math
+{
+    namespace detail::Summation
+    {
+        // Adds `x` to `sum`, and the rounding error of that to `error`. This is Knuth's TwoSum, which computes the exact error without branching.
+        template <typename T>
+        constexpr void CompensatedAdd(T &sum, T &error, const T &x)
+        {
+            const T new_sum = sum + x;
+            const T x_rounded = new_sum - sum;
+            error += (sum - (new_sum - x_rounded)) + (x - x_rounded);
+            sum = new_sum;
+        }
+
+        // Computes `a * b` and its exact rounding error, elementwise for vectors.
+        template <typename T>
+        constexpr void TwoProduct(const T &a, const T &b, T &product, T &error)
+        {
+            apply_elementwise([]<std::floating_point X>(X x, X y, X &p, X &e){Funcs::TwoProduct(x, y, p, e);}, a, b, product, error);
+        }
+    }
+
+    // Accumulates a sum, keeping track of the rounding errors separately.
+    // This is Neumaier's improvement of the Kahan summation, with the branch replaced with Knuth's TwoSum,
+    //   which makes it branchless, so it works on vectors elementwise.
+    // The error is O(1) ulp plus O(n * epsilon^2) relative to the sum of absolute values, instead of O(n * epsilon) for the plain loop.
+    template <floating_point_vector_or_scalar T>
+    struct compensated_sum
+    {
+        T sum{};
+        // The sum of the rounding errors, which is added to `sum` in `value()`.
+        T error{};
+
+        constexpr compensated_sum() {}
+        constexpr explicit compensated_sum(const T &sum) : sum(sum) {}
+
+        constexpr compensated_sum &operator+=(const T &x)
+        {
+            detail::Summation::CompensatedAdd(sum, error, x);
+            return *this;
+        }
+
+        // Merges two partial sums.
+        constexpr compensated_sum &operator+=(const compensated_sum &other)
+        {
+            *this += other.sum;
+            error += other.error;
+            return *this;
+        }
+
+        // Adds `a * b`, also keeping the rounding error of the product (which is computed exactly).
+        constexpr void add_product(const T &a, const T &b)
+        {
+            T product, product_error;
+            detail::Summation::TwoProduct(a, b, product, product_error);
+            *this += product;
+            error += product_error;
+        }
+
+        [[nodiscard]] constexpr T value() const {return sum + error;}
+    };
+
+    // Sums spans of floating-point numbers or vectors (which are summed elementwise).
+    template <floating_point_vector_or_scalar T>
+    struct summation
+    {
+        // The compensated sums use this many independent accumulators per block, each with its own compensation term.
+        // Then the additions don't wait for each other, and the compiler can put the lanes into SIMD registers.
+        // This is deliberately more than 16: GCC at `-O3` completely unrolls shorter lane loops before vectorizing them,
+        //   and then fails to vectorize the result, which makes `compensated()` twice as slow as at `-O2`.
+        static constexpr std::size_t num_lanes = 32;
+        // The compensated sums are computed separately for the blocks of this many elements, which are then merged in index order.
+        // The blocks don't depend on the number of threads, so neither does the result.
+        static constexpr std::size_t block_size = 1 << 12;
+        // Inputs with less than this many elements per thread use fewer threads.
+        static constexpr std::size_t min_elements_per_thread = 1 << 16;
+        // `pairwise()` sums the blocks of this size with plain loops, using this many independent accumulators.
+        static constexpr std::size_t pairwise_block_size = 128;
+        static constexpr std::size_t pairwise_num_lanes = 8;
+
+      private:
+        // Sums `term(i, error)` for all `i` in `[0, n)`. The `term()` can add its own rounding error to `error`.
+        [[nodiscard]] static constexpr T Reduce(std::size_t n, int num_threads, auto &&term)
+        {
+            const std::size_t num_blocks = (n + block_size - 1) / block_size;
+            std::vector<compensated_sum<T>> block_sums;
+            block_sums.resize(num_blocks);
+
+            parallel_for(num_blocks, num_threads, min_elements_per_thread / block_size, [&](int, std::size_t begin_block, std::size_t end_block)
+            {
+                for (std::size_t block = begin_block; block < end_block; block++)
+                {
+                    const std::size_t begin = block * block_size;
+                    const std::size_t end = std::min(n, begin + block_size);
+
+                    // Separate arrays for the sums and the errors, which vectorizes much better than an array of `compensated_sum`s.
+                    T sums[num_lanes]{};
+                    T errors[num_lanes]{};
+                    std::size_t i = begin;
+                    for (; end - i >= num_lanes; i += num_lanes)
+                    {
+                        for (std::size_t j = 0; j < num_lanes; j++)
+                            detail::Summation::CompensatedAdd(sums[j], errors[j], term(i + j, errors[j]));
+                    }
+
+                    compensated_sum<T> &block_sum = block_sums[block];
+                    for (std::size_t j = 0; j < num_lanes; j++)
+                    {
+                        block_sum += sums[j];
+                        block_sum.error += errors[j];
+                    }
+                    for (; i < end; i++)
+                        detail::Summation::CompensatedAdd(block_sum.sum, block_sum.error, term(i, block_sum.error));
+                }
+            });
+
+            compensated_sum<T> ret;
+            for (const compensated_sum<T> &block_sum : block_sums)
+                ret += block_sum;
+            return ret.value();
+        }
+
+        [[nodiscard]] static constexpr T Pairwise(std::span<const T> values)
+        {
+            if (values.size() <= pairwise_block_size)
+            {
+                T sums[pairwise_num_lanes]{};
+                std::size_t i = 0;
+                for (; values.size() - i >= pairwise_num_lanes; i += pairwise_num_lanes)
+                {
+                    for (std::size_t j = 0; j < pairwise_num_lanes; j++)
+                        sums[j] += values[i + j];
+                }
+                for (; i < values.size(); i++)
+                    sums[0] += values[i];
+                for (std::size_t j = 1; j < pairwise_num_lanes; j++)
+                    sums[0] += sums[j];
+                return sums[0];
+            }
+
+            const std::size_t half = values.size() / 2;
+            return Pairwise(values.first(half)) + Pairwise(values.subspan(half));
+        }
+
+      public:
+        // The compensated sum, see `compensated_sum`. The result is nearly the correctly rounded exact sum, unless there's a lot of cancellation.
+        // `num_threads == 0` means `std::thread::hardware_concurrency()`.
+        // On one thread this is about as fast as the plain loop (both are limited by the memory bandwidth on large inputs), but only if the lanes get vectorized.
+        [[nodiscard]] static constexpr T compensated(std::span<const T> values, int num_threads = 0)
+        {
+            return Reduce(values.size(), num_threads, [&](std::size_t i, T &){return values[i];});
+        }
+
+        // The compensated sum of `a[i] * b[i]` (elementwise for vectors, call `.sum()` on the result to get the sum of dot products).
+        // The rounding errors of the products are computed exactly and added to the compensation,
+        //   so this is about as accurate as computing in twice the precision and then rounding.
+        // The errors use a hardware FMA if there is one (e.g. with `-mfma` or `-march=...` on x86), otherwise Dekker's algorithm,
+        //   which is just as exact, but has more operations per element and is somewhat slower.
+        [[nodiscard]] static constexpr T compensated_dot(std::span<const T> a, std::span<const T> b, int num_threads = 0)
+        {
+            if (a.size() != b.size())
+                throw std::length_error("The spans for a dot product have different sizes.");
+            return Reduce(a.size(), num_threads, [&](std::size_t i, T &error)
+            {
+                T product, product_error;
+                detail::Summation::TwoProduct(a[i], b[i], product, product_error);
+                error += product_error;
+                return product;
+            });
+        }
+
+        // The pairwise (cascade) summation: sums the two halves recursively and adds them together.
+        // The error is O(log(n) * epsilon), which is worse than `compensated()`, but this is about as fast as the plain loop.
+        [[nodiscard]] static constexpr T pairwise(std::span<const T> values)
+        {
+            return Pairwise(values);
+        }
+    };
+
+    inline namespace Common
+    {
+        using Math::compensated_sum;
+        using Math::summation;
+    }
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "em/math/namespaces.h"
+#include "em/math/parallel.h"
+#include "em/math/rect.h"
+#include "em/math/scalar.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+// The sweep-and-prune broad phase: finds all overlapping pairs among many moving rects.
+
+namespace em::Math
+{
+    // A pair of overlapping rects, with `a < b`.
+    struct sweep_and_prune_pair
+    {
+        std::uint32_t a = 0;
+        std::uint32_t b = 0;
+
+        [[nodiscard]] friend constexpr bool operator==(const sweep_and_prune_pair &, const sweep_and_prune_pair &) = default;
+    };
+
+    // Keeps the rects sorted by their minimum X between the calls to `update()`. When they move a bit each frame, they stay nearly sorted,
+    //   so re-sorting them with the insertion sort is close to linear.
+    // The overlaps are the same as in `rect::overlaps()`: touching doesn't count, and empty rects overlap nothing.
+    // Holds on to its memory, so calling it every frame doesn't allocate.
+    // The number of rects is limited to `2^32 - 1`.
+    template <scalar T, int N = 2>
+    class sweep_and_prune
+    {
+      public:
+        using rect_type = rect<T, N>;
+
+        // Inputs with less than this many rects per thread use fewer threads.
+        static constexpr std::size_t min_elements_per_thread = 1 << 12;
+
+      private:
+        // The rects sorted by `a.x`, and their original indices.
+        std::vector<rect_type> sorted_rects;
+        std::vector<std::uint32_t> order;
+
+        // The pairs found by each chunk, where each chunk starts in `pairs`, and then all pairs.
+        std::vector<std::vector<sweep_and_prune_pair>> chunk_pairs;
+        std::vector<std::size_t> chunk_offsets;
+        std::vector<sweep_and_prune_pair> pairs;
+
+        // Sorts `sorted_rects` and `order` together, assuming they're nearly sorted.
+        constexpr void InsertionSort()
+        {
+            for (std::size_t i = 1; i < sorted_rects.size(); i++)
+            {
+                if (!(sorted_rects[i].a[0] < sorted_rects[i - 1].a[0]))
+                    continue;
+
+                rect_type r = std::move(sorted_rects[i]);
+                std::uint32_t index = order[i];
+                std::size_t j = i;
+                do
+                {
+                    sorted_rects[j] = std::move(sorted_rects[j - 1]);
+                    order[j] = order[j - 1];
+                    j--;
+                }
+                while (j > 0 && r.a[0] < sorted_rects[j - 1].a[0]);
+                sorted_rects[j] = std::move(r);
+                order[j] = index;
+            }
+        }
+
+      public:
+        constexpr sweep_and_prune() {}
+
+        // The number of rects.
+        [[nodiscard]] constexpr std::size_t size() const {return order.size();}
+
+        // Frees the memory.
+        constexpr void clear()
+        {
+            sorted_rects = {};
+            order = {};
+            chunk_pairs = {};
+            chunk_offsets = {};
+            pairs = {};
+        }
+
+        // Sets the new positions of the rects.
+        // If the number of rects is the same as last time, they're assumed to be the same rects that moved a bit, and are re-sorted incrementally.
+        // Otherwise they're sorted from scratch.
+        constexpr void update(std::span<const rect_type> rects)
+        {
+            if (rects.size() > std::numeric_limits<std::uint32_t>::max())
+                throw std::length_error("Too many rects for the sweep-and-prune.");
+
+            const std::size_t n = rects.size();
+            sorted_rects.resize(n);
+            if (order.size() != n)
+            {
+                order.resize(n);
+                std::iota(order.begin(), order.end(), std::uint32_t(0));
+                std::sort(order.begin(), order.end(), [&](std::uint32_t x, std::uint32_t y){return rects[x].a[0] < rects[y].a[0];});
+                for (std::size_t i = 0; i < n; i++)
+                    sorted_rects[i] = rects[order[i]];
+            }
+            else
+            {
+                for (std::size_t i = 0; i < n; i++)
+                    sorted_rects[i] = rects[order[i]];
+                InsertionSort();
+            }
+        }
+
+        // Returns all pairs of the overlapping rects, from the last `update()`. The pairs are in no particular order.
+        // The returned span is valid until the next call. `num_threads == 0` means `std::thread::hardware_concurrency()`.
+        constexpr std::span<const sweep_and_prune_pair> find_pairs(int num_threads = 0)
+        {
+            const std::size_t n = sorted_rects.size();
+            const int num_chunks = parallel_chunk_count(n, num_threads, min_elements_per_thread);
+            if (chunk_pairs.size() < std::size_t(num_chunks))
+                chunk_pairs.resize(std::size_t(num_chunks));
+
+            // Each chunk sweeps from its own rects to the right, possibly past the end of the chunk.
+            parallel_for_chunks(n, num_chunks, [&](int chunk, std::size_t begin, std::size_t end)
+            {
+                std::vector<sweep_and_prune_pair> &out = chunk_pairs[std::size_t(chunk)];
+                out.clear();
+                for (std::size_t i = begin; i < end; i++)
+                {
+                    const rect_type &r = sorted_rects[i];
+                    for (std::size_t j = i + 1; j < n && sorted_rects[j].a[0] < r.b[0]; j++)
+                    {
+                        if (r.overlaps(sorted_rects[j]))
+                            out.push_back({std::min(order[i], order[j]), std::max(order[i], order[j])});
+                    }
+                }
+            });
+
+            chunk_offsets.resize(std::size_t(num_chunks) + 1);
+            for (std::size_t i = 0; i < std::size_t(num_chunks); i++)
+                chunk_offsets[i + 1] = chunk_offsets[i] + chunk_pairs[i].size();
+            pairs.resize(chunk_offsets.back());
+            parallel_for_chunks(std::size_t(num_chunks), num_chunks, [&](int chunk, std::size_t, std::size_t)
+            {
+                std::copy(chunk_pairs[std::size_t(chunk)].begin(), chunk_pairs[std::size_t(chunk)].end(), pairs.begin() + std::ptrdiff_t(chunk_offsets[std::size_t(chunk)]));
+            });
+
+            return pairs;
+        }
+    };
+
+    inline namespace Common
+    {
+        using Math::sweep_and_prune;
+        using Math::sweep_and_prune_pair;
+    }
+}
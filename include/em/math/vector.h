@@ -16,8 +16,13 @@
 #include "em/meta/common.h"
 #include "em/meta/functional.h"
 
+#include <bit>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 
 // This header is self-sufficient for vectors. The overloaded operators for vectors are included here too.
@@ -258,14 +263,14 @@ namespace em::Math
         struct MaybeSameVecSize
         {
             template <typename ...P>
-            requires requires{common_vec_size<P...>;}
+            requires requires{common_vec_size<P...>;} && (!Customize::ContainsVectorsElementwise<std::remove_cvref_t<P>>::value && ...)
             static constexpr int value = common_vec_size<P...>;
         };
         template <>
         struct MaybeSameVecSize<true>
         {
             template <typename ...P>
-            requires requires{vec_size<P...>;}
+            requires requires{vec_size<P...>;} && (!Customize::ContainsVectorsElementwise<std::remove_cvref_t<P>>::value && ...)
             static constexpr int value = vec_size<P...>;
         };
 
@@ -304,6 +309,14 @@ namespace em::Math::inline Common
     using Math::with_default_component;
 }
 
+// Vectors of scalars have the same layout as arrays of their elements, so spans of them can be copied and saved to files as bytes.
+#define DETAIL_EM_X(t_, type_) \
+    static_assert(std::is_trivially_copyable_v<em::Math::vec2<type_>> && sizeof(em::Math::vec2<type_>) == sizeof(type_) * 2); \
+    static_assert(std::is_trivially_copyable_v<em::Math::vec3<type_>> && sizeof(em::Math::vec3<type_>) == sizeof(type_) * 3); \
+    static_assert(std::is_trivially_copyable_v<em::Math::vec4<type_>> && sizeof(em::Math::vec4<type_>) == sizeof(type_) * 4);
+EM_MATH_TYPE_SHORTHANDS(DETAIL_EM_X)
+#undef DETAIL_EM_X
+
 
 // Implement the tuple protocol for vectors:
 
@@ -321,3 +334,79 @@ namespace em::Math
         return (vec_elem)(I, EM_FWD(vec));
     }
 }
+
+
+// Implement `std::hash` for vectors:
+
+namespace em::Math::detail::Vector
+{
+    // The MurmurHash3 64-bit finalizer. It's a bijection, so it never introduces collisions by itself.
+    [[nodiscard]] EM_TINY constexpr std::uint64_t MixHash(std::uint64_t h) noexcept
+    {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccd;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // Which element types we hash by their bits, as opposed to calling `std::hash` on them.
+    // `long double` is excluded because it can have padding bits.
+    template <typename T>
+    concept HashableAsBits = std::is_integral_v<T> || std::is_enum_v<T> || std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+    // Returns the bits of the element as an unsigned integer, making sure that equal values give equal bits.
+    template <HashableAsBits T>
+    [[nodiscard]] EM_TINY constexpr auto ElemBits(T value) noexcept
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            if (value == 0)
+                value = 0; // Replace `-0` with `+0`.
+            else if (value != value)
+                value = std::numeric_limits<T>::quiet_NaN(); // Canonicalize NaNs, just in case.
+            return std::bit_cast<std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>(value);
+        }
+        else if constexpr (std::is_same_v<T, bool>)
+        {
+            return std::uint8_t(value);
+        }
+        else
+        {
+            return std::make_unsigned_t<typename std::conditional_t<std::is_enum_v<T>, std::underlying_type<T>, std::type_identity<T>>::type>(value);
+        }
+    }
+}
+
+// If the elements are small enough integers or floats (e.g. `ivec2`, `fvec2`, `u16vec4`), they're packed into a single 64-bit word,
+//   which is then mixed once. This makes collisions impossible for those, at least on 64-bit platforms.
+// Larger vectors of integers or floats are mixed word by word. Other element types fall back to their own `std::hash`.
+template <typename T, int N> requires em::Math::detail::Vector::HashableAsBits<T> || std::is_default_constructible_v<std::hash<T>>
+struct std::hash<em::Math::vec<T, N>>
+{
+    [[nodiscard]] constexpr std::size_t operator()(const em::Math::vec<T, N> &v) const noexcept
+    {
+        using namespace em::Math::detail::Vector;
+
+        if constexpr (HashableAsBits<T> && sizeof(T) * N <= sizeof(std::uint64_t))
+        {
+            std::uint64_t packed = 0;
+            for (int i = 0; i < N; i++)
+                packed |= std::uint64_t(ElemBits(v[i])) << (i * sizeof(T) * 8);
+            return std::size_t(MixHash(packed));
+        }
+        else
+        {
+            std::uint64_t ret = N;
+            for (int i = 0; i < N; i++)
+            {
+                if constexpr (HashableAsBits<T>)
+                    ret = MixHash(ret ^ std::uint64_t(ElemBits(v[i])));
+                else
+                    ret = MixHash(ret ^ std::uint64_t(std::hash<T>{}(v[i])));
+            }
+            return std::size_t(ret);
+        }
+    }
+};
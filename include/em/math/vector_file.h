@@ -0,0 +1,337 @@
+#pragma once
+
+#include "em/math/namespaces.h"
+#include "em/math/parallel.h"
+#include "em/math/vector.h"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// A minimal binary format for arrays of vectors (or scalars), and a reader that memory-maps the files to use them without copying.
+// The file is a 16-byte `vec_file_header` followed by the raw elements, with no padding anywhere.
+
+namespace em::Math
+{
+    static_assert(std::endian::native == std::endian::little || std::endian::native == std::endian::big, "Mixed-endian platforms are not supported.");
+
+    // The element types that can be stored in the files.
+    enum class vec_file_elem_type : std::uint8_t
+    {
+        i8, u8, i16, u16, i32, u32, i64, u64, f32, f64,
+    };
+
+    namespace detail::VecFile
+    {
+        template <typename T> struct ElemType {};
+        template <> struct ElemType<std::int8_t  > {static constexpr vec_file_elem_type value = vec_file_elem_type::i8 ;};
+        template <> struct ElemType<std::uint8_t > {static constexpr vec_file_elem_type value = vec_file_elem_type::u8 ;};
+        template <> struct ElemType<std::int16_t > {static constexpr vec_file_elem_type value = vec_file_elem_type::i16;};
+        template <> struct ElemType<std::uint16_t> {static constexpr vec_file_elem_type value = vec_file_elem_type::u16;};
+        template <> struct ElemType<std::int32_t > {static constexpr vec_file_elem_type value = vec_file_elem_type::i32;};
+        template <> struct ElemType<std::uint32_t> {static constexpr vec_file_elem_type value = vec_file_elem_type::u32;};
+        template <> struct ElemType<std::int64_t > {static constexpr vec_file_elem_type value = vec_file_elem_type::i64;};
+        template <> struct ElemType<std::uint64_t> {static constexpr vec_file_elem_type value = vec_file_elem_type::u64;};
+        template <> struct ElemType<float        > {static constexpr vec_file_elem_type value = vec_file_elem_type::f32;};
+        template <> struct ElemType<double       > {static constexpr vec_file_elem_type value = vec_file_elem_type::f64;};
+
+        // Reverses the bytes of an integer or a float.
+        template <typename T>
+        [[nodiscard]] constexpr T ByteSwap(T value)
+        {
+            if constexpr (sizeof(T) == 1)
+                return value;
+            else if constexpr (std::is_integral_v<T>)
+                return std::byteswap(value);
+            else
+                return std::bit_cast<T>(std::byteswap(std::bit_cast<std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>(value)));
+        }
+    }
+
+    // The types that can be stored in the files. `long double` and `bool` are rejected, since their representation isn't portable.
+    template <typename T>
+    concept vec_file_scalar = requires{detail::VecFile::ElemType<T>::value;} && (!std::is_floating_point_v<T> || std::numeric_limits<T>::is_iec559);
+
+    // The file header. The multibyte fields are stored in the byte order of the file, same as the elements.
+    struct vec_file_header
+    {
+        static constexpr std::array<char, 4> expected_magic = {'E', 'M', 'V', 'F'};
+        static constexpr std::uint8_t current_version = 1;
+
+        std::array<char, 4> magic = expected_magic;
+        std::uint8_t version = current_version;
+        // 1 if the file is big-endian, 0 if little-endian.
+        std::uint8_t big_endian = std::endian::native == std::endian::big;
+        vec_file_elem_type elem_type{};
+        // The vector size, 1 for scalars.
+        std::uint8_t dims = 0;
+        // The number of vectors.
+        std::uint64_t count = 0;
+
+        // True if the file uses the opposite byte order, and the elements need `vec_file::byte_swap()` before they can be used.
+        [[nodiscard]] constexpr bool is_foreign() const {return bool(big_endian) != (std::endian::native == std::endian::big);}
+
+        // The `count` converted to the native byte order.
+        [[nodiscard]] constexpr std::uint64_t native_count() const {return is_foreign() ? detail::VecFile::ByteSwap(count) : count;}
+
+        [[nodiscard]] friend constexpr bool operator==(const vec_file_header &, const vec_file_header &) = default;
+    };
+    static_assert(sizeof(vec_file_header) == 16 && std::is_trivially_copyable_v<vec_file_header>);
+
+    // A read-only memory mapping of a whole file. Move-only.
+    class mapped_file
+    {
+        const std::byte *data = nullptr;
+        std::size_t size = 0;
+
+        #ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+        #endif
+
+        void Close() noexcept
+        {
+            #ifdef _WIN32
+            if (data)
+                UnmapViewOfFile(data);
+            if (mapping)
+                CloseHandle(mapping);
+            if (file != INVALID_HANDLE_VALUE)
+                CloseHandle(file);
+            file = INVALID_HANDLE_VALUE;
+            mapping = nullptr;
+            #else
+            if (data)
+                munmap(const_cast<std::byte *>(data), size);
+            #endif
+            data = nullptr;
+            size = 0;
+        }
+
+      public:
+        mapped_file() {}
+
+        // Throws on failure. An empty file gives an empty span.
+        explicit mapped_file(const std::filesystem::path &path)
+        {
+            #ifdef _WIN32
+            file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+                throw std::runtime_error("Unable to open `" + path.string() + "` for reading.");
+            LARGE_INTEGER file_size{};
+            if (!GetFileSizeEx(file, &file_size))
+            {
+                Close();
+                throw std::runtime_error("Unable to get the size of `" + path.string() + "`.");
+            }
+            size = std::size_t(file_size.QuadPart);
+            if (size > 0)
+            {
+                mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (mapping)
+                    data = static_cast<const std::byte *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                if (!data)
+                {
+                    Close();
+                    throw std::runtime_error("Unable to memory-map `" + path.string() + "`.");
+                }
+            }
+            #else
+            const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd == -1)
+                throw std::runtime_error("Unable to open `" + path.string() + "` for reading.");
+            struct stat file_stat{};
+            if (fstat(fd, &file_stat) != 0)
+            {
+                close(fd);
+                throw std::runtime_error("Unable to get the size of `" + path.string() + "`.");
+            }
+            size = std::size_t(file_stat.st_size);
+            if (size > 0)
+            {
+                void *ptr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (ptr == MAP_FAILED)
+                {
+                    close(fd);
+                    size = 0;
+                    throw std::runtime_error("Unable to memory-map `" + path.string() + "`.");
+                }
+                data = static_cast<const std::byte *>(ptr);
+            }
+            close(fd); // The mapping stays valid after this.
+            #endif
+        }
+
+        mapped_file(mapped_file &&other) noexcept
+            : data(std::exchange(other.data, nullptr)), size(std::exchange(other.size, 0))
+            #ifdef _WIN32
+            , file(std::exchange(other.file, INVALID_HANDLE_VALUE)), mapping(std::exchange(other.mapping, nullptr))
+            #endif
+        {}
+        mapped_file &operator=(mapped_file other) noexcept
+        {
+            std::swap(data, other.data);
+            std::swap(size, other.size);
+            #ifdef _WIN32
+            std::swap(file, other.file);
+            std::swap(mapping, other.mapping);
+            #endif
+            return *this;
+        }
+        ~mapped_file() {Close();}
+
+        [[nodiscard]] std::span<const std::byte> bytes() const {return {data, size};}
+    };
+
+    // Reads and writes the arrays of `vec<T, N>` (or `T` for `N == 1`).
+    // The element type is a parameter of the class, since most of the functions only receive a `mapped_file` and have nothing to deduce it from.
+    template <vec_file_scalar T, int N>
+    requires(N >= 1 && N <= 4)
+    struct vec_file
+    {
+        using elem_type = vec_or_scalar<T, N>;
+        static_assert(sizeof(elem_type) == sizeof(T) * N, "The vectors must have no padding.");
+
+        // Inputs with less than this many elements per thread use fewer threads.
+        static constexpr std::size_t min_elements_per_thread = 1 << 16;
+
+        // The header for this element type, in the native byte order.
+        [[nodiscard]] static constexpr vec_file_header make_header(std::uint64_t count)
+        {
+            vec_file_header ret;
+            ret.elem_type = detail::VecFile::ElemType<T>::value;
+            ret.dims = std::uint8_t(N);
+            ret.count = count;
+            return ret;
+        }
+
+        // Throws if the header is invalid or is for a different element type. Doesn't care about the byte order.
+        static constexpr void check_header(const vec_file_header &header)
+        {
+            if (header.magic != vec_file_header::expected_magic)
+                throw std::runtime_error("This is not a vector file.");
+            if (header.version != vec_file_header::current_version)
+                throw std::runtime_error("Unsupported vector file version.");
+            if (header.elem_type != detail::VecFile::ElemType<T>::value || header.dims != N)
+                throw std::runtime_error("The vector file has a different element type.");
+        }
+
+        // Reverses the byte order of each component, writing to `output` (which can be the same span).
+        // `num_threads == 0` means `std::thread::hardware_concurrency()`.
+        static constexpr void byte_swap(std::span<const elem_type> input, std::span<elem_type> output, int num_threads = 0)
+        {
+            if (output.size() < input.size())
+                throw std::length_error("The output span for byte-swapping is too small.");
+
+            parallel_for(input.size(), num_threads, min_elements_per_thread, [&](int, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; i++)
+                {
+                    if constexpr (N == 1)
+                    {
+                        output[i] = detail::VecFile::ByteSwap(input[i]);
+                    }
+                    else
+                    {
+                        elem_type v = input[i];
+                        for (int j = 0; j < N; j++)
+                            v[j] = detail::VecFile::ByteSwap(v[j]);
+                        output[i] = v;
+                    }
+                }
+            });
+        }
+
+        // Writes the header and the data, in the native byte order.
+        static void save(const std::filesystem::path &path, std::span<const elem_type> data)
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            if (!file)
+                throw std::runtime_error("Unable to open `" + path.string() + "` for writing.");
+            const vec_file_header header = make_header(data.size());
+            file.write(reinterpret_cast<const char *>(&header), sizeof header);
+            file.write(reinterpret_cast<const char *>(data.data()), std::streamsize(data.size_bytes()));
+            if (!file.flush())
+                throw std::runtime_error("Unable to write to `" + path.string() + "`.");
+        }
+
+        // Returns the header of a mapped file, after checking it, and that the file is large enough.
+        [[nodiscard]] static vec_file_header header(const mapped_file &file)
+        {
+            const std::span<const std::byte> bytes = file.bytes();
+            vec_file_header ret;
+            if (bytes.size() < sizeof ret)
+                throw std::runtime_error("The vector file is too small.");
+            std::memcpy(&ret, bytes.data(), sizeof ret);
+            check_header(ret);
+            if (ret.native_count() > (bytes.size() - sizeof ret) / sizeof(elem_type))
+                throw std::runtime_error("The vector file is truncated.");
+            return ret;
+        }
+
+        // Returns the elements of a mapped file without copying them. The span is valid as long as the `mapped_file` is alive.
+        // Throws if the file has the foreign byte order, use `read()` for those.
+        [[nodiscard]] static std::span<const elem_type> view(const mapped_file &file)
+        {
+            const vec_file_header h = header(file);
+            if (h.is_foreign())
+                throw std::runtime_error("The vector file has the foreign byte order, it must be read with byte swapping.");
+            // The header size is a multiple of the element alignment, and the mapping is page-aligned, so the elements are aligned too.
+            return {reinterpret_cast<const elem_type *>(file.bytes().data() + sizeof(vec_file_header)), std::size_t(h.count)};
+        }
+
+        // The number of elements in the mapped file, in the native byte order.
+        [[nodiscard]] static std::size_t count(const mapped_file &file)
+        {
+            return std::size_t(header(file).native_count());
+        }
+
+        // Copies the elements of a mapped file to `output` (at least `count(file)` elements), swapping the byte order if necessary.
+        static void read(const mapped_file &file, std::span<elem_type> output, int num_threads = 0)
+        {
+            const vec_file_header h = header(file);
+            const std::size_t n = std::size_t(h.native_count());
+            if (output.size() < n)
+                throw std::length_error("The output span for reading a vector file is too small.");
+
+            const std::byte *source = file.bytes().data() + sizeof(vec_file_header);
+            std::memcpy(output.data(), source, n * sizeof(elem_type));
+            if (h.is_foreign())
+                byte_swap(output.first(n), output.first(n), num_threads);
+        }
+    };
+
+    inline namespace Common
+    {
+        using Math::mapped_file;
+        using Math::vec_file;
+        using Math::vec_file_elem_type;
+        using Math::vec_file_header;
+        using Math::vec_file_scalar;
+    }
+}
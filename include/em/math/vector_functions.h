@@ -0,0 +1,46 @@
+#pragma once
+
+#include "em/macros/utils/functors.h"
+#include "em/macros/utils/returns.h"
+#include "em/math/functions.h"
+#include "em/math/namespaces.h"
+#include "em/math/vector.h"
+
+// Geometric functions on vectors: dot and cross products, lengths, etc.
+
+namespace em::Math
+{
+    // The dot product.
+    EM_SIMPLE_FUNCTOR( dot,, (const vector auto &a, const vector auto &b) EM_RETURNS((a * b).sum()) )
+
+    // The cross product. For 3D vectors returns a vector, for 2D vectors returns the Z component of the 3D cross product.
+    EM_SIMPLE_FUNCTOR( cross,
+        (template <typename A, typename B>), (const vec2<A> &a, const vec2<B> &b) EM_RETURNS(a.x * b.y - a.y * b.x)
+        EM_OVERLOAD
+        (template <typename A, typename B>), (const vec3<A> &a, const vec3<B> &b) EM_RETURNS(vec(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x))
+    )
+
+    // The squared length. Prefer this to `length()` when you only need to compare the lengths.
+    EM_SIMPLE_FUNCTOR( length_sq,, (const vector auto &a) EM_RETURNS(dot(a, a)) )
+    // The length, always floating-point.
+    EM_SIMPLE_FUNCTOR( length,, (const vector auto &a) EM_RETURNS(sqrt(length_sq(a))) )
+
+    // The squared distance between two points.
+    EM_SIMPLE_FUNCTOR( distance_sq,, (const vector auto &a, const vector auto &b) EM_RETURNS(length_sq(b - a)) )
+    // The distance between two points, always floating-point.
+    EM_SIMPLE_FUNCTOR( distance,, (const vector auto &a, const vector auto &b) EM_RETURNS(length(b - a)) )
+
+    // Returns the vector divided by its length. Returns NaNs for zero vectors.
+    EM_SIMPLE_FUNCTOR( normalize,, (const vector auto &a) EM_RETURNS(a / length(a)) )
+
+    inline namespace Common
+    {
+        using Math::dot;
+        using Math::cross;
+        using Math::length_sq;
+        using Math::length;
+        using Math::distance_sq;
+        using Math::distance;
+        using Math::normalize;
+    }
+}
@@ -0,0 +1,237 @@
+#pragma once
+
+#include "em/math/namespaces.h"
+#include "em/math/scalar.h"
+#include "em/math/vector.h"
+#include "em/math/vector_traits.h"
+
+#include <charconv>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+#if __has_include(<format>)
+#include <format>
+#endif
+
+// Converting vectors to and from text, without locales, allocations or iostreams.
+// This uses `std::to_chars()` and `std::from_chars()`, so the floats are printed in the shortest form that reads back to the same value.
+// Everything is `constexpr`, but the standard functions are only `constexpr` for integers (since C++23), so in constant evaluation this only works
+//   with integers (if the standard library supports it, see `__cpp_lib_constexpr_charconv`) and bools.
+
+namespace em::Math
+{
+    // How the vectors are written, e.g. `(1, 2, 3)` by default, or `1 2 3` with `{.open = 0, .close = 0, .separator = 0}`.
+    // When parsing, the brackets are optional (but must match), the whitespace is skipped, and a whitespace alone also works as a separator.
+    struct vec_text_style
+    {
+        // Set those to 0 to disable them.
+        char open = '(';
+        char close = ')';
+
+        // Set this to 0 to separate the elements with spaces only.
+        char separator = ',';
+        // Only affects writing.
+        bool space_after_separator = true;
+    };
+
+    // Reads and writes vectors `V` (or scalars) as text.
+    template <vector_or_scalar V>
+    struct vec_text
+    {
+        using type = V;
+        using elem_type = vec_base_t<V>;
+
+        // The max length of one `to_chars()` output, with any style. It's enough for any float in its shortest form, or any integer.
+        static constexpr std::size_t max_chars = (32 + 2) * vec_size<V> + 2;
+
+      private:
+        [[nodiscard]] static constexpr bool IsSpace(char ch)
+        {
+            return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r' || ch == '\v' || ch == '\f';
+        }
+
+        [[nodiscard]] static constexpr const char *SkipSpaces(const char *first, const char *last)
+        {
+            while (first != last && IsSpace(*first))
+                first++;
+            return first;
+        }
+
+        [[nodiscard]] static constexpr std::from_chars_result ParseElem(const char *first, const char *last, elem_type &out)
+        {
+            if constexpr (std::is_same_v<elem_type, bool>)
+            {
+                // Accept `0` and `1` only.
+                if (first != last && (*first == '0' || *first == '1'))
+                {
+                    out = *first == '1';
+                    return {first + 1, std::errc{}};
+                }
+                return {first, std::errc::invalid_argument};
+            }
+            else
+            {
+                return std::from_chars(first, last, out);
+            }
+        }
+
+      public:
+        // Parses a vector from the beginning of `[first, last)`, skipping the leading whitespace. Doesn't modify `out` on failure.
+        // Returns the pointer past the parsed characters. On failure, returns `first` and a non-zero error code, like `std::from_chars()`.
+        [[nodiscard]] static constexpr std::from_chars_result from_chars(const char *first, const char *last, V &out, const vec_text_style &style = {})
+        {
+            const char *cur = SkipSpaces(first, last);
+
+            const bool has_brackets = style.open && cur != last && *cur == style.open;
+            if (has_brackets)
+                cur = SkipSpaces(cur + 1, last);
+
+            V ret{};
+            for (int i = 0; i < vec_size<V>; i++)
+            {
+                if (i > 0 && style.separator && cur != last && *cur == style.separator)
+                    cur = SkipSpaces(cur + 1, last);
+
+                std::from_chars_result elem_result = ParseElem(cur, last, vec_elem(i, ret));
+                if (elem_result.ec != std::errc{})
+                    return {first, elem_result.ec};
+                cur = elem_result.ptr;
+
+                if (i + 1 < vec_size<V> || has_brackets)
+                    cur = SkipSpaces(cur, last);
+            }
+
+            if (has_brackets)
+            {
+                if (cur == last || *cur != style.close)
+                    return {first, std::errc::invalid_argument};
+                cur++;
+            }
+
+            out = ret;
+            return {cur, std::errc{}};
+        }
+
+        // Writes a vector to `[first, last)`. `max_chars` characters are always enough.
+        // On failure returns `last` and `std::errc::value_too_large`, like `std::to_chars()`.
+        [[nodiscard]] static constexpr std::to_chars_result to_chars(char *first, char *last, const V &value, const vec_text_style &style = {})
+        {
+            auto put = [&](char ch)
+            {
+                if (first == last)
+                    return false;
+                *first++ = ch;
+                return true;
+            };
+
+            // No brackets around scalars.
+            const bool brackets = vec_size<V> > 1;
+
+            if (brackets && style.open && !put(style.open))
+                return {last, std::errc::value_too_large};
+
+            for (int i = 0; i < vec_size<V>; i++)
+            {
+                if (i > 0)
+                {
+                    // Without a separator there must be a space anyway.
+                    const bool space = (style.space_after_separator || !style.separator) && style.separator != ' ';
+                    if ((style.separator && !put(style.separator)) || (space && !put(' ')))
+                        return {last, std::errc::value_too_large};
+                }
+
+                const elem_type &elem = vec_elem(i, value);
+                std::to_chars_result elem_result;
+                if constexpr (std::is_same_v<elem_type, bool>)
+                    elem_result = put(elem ? '1' : '0') ? std::to_chars_result{first, std::errc{}} : std::to_chars_result{last, std::errc::value_too_large};
+                else
+                    elem_result = std::to_chars(first, last, elem);
+                if (elem_result.ec != std::errc{})
+                    return elem_result;
+                first = elem_result.ptr;
+            }
+
+            if (brackets && style.close && !put(style.close))
+                return {last, std::errc::value_too_large};
+
+            return {first, std::errc{}};
+        }
+
+        // Writes a vector to a string.
+        [[nodiscard]] static constexpr std::string to_string(const V &value, const vec_text_style &style = {})
+        {
+            char buffer[max_chars];
+            return std::string(buffer, to_chars(buffer, buffer + max_chars, value, style).ptr);
+        }
+
+        // Parses vectors one after another into `out` (e.g. `1 2 3\n4 5 6` into `fvec3`s), until either the text or `out` ends.
+        // Returns the number of parsed vectors, and optionally the position where it stopped. Throws on invalid text.
+        static constexpr std::size_t parse_batch(std::string_view text, std::span<V> out, const vec_text_style &style = {}, std::size_t *out_offset = nullptr)
+        {
+            const char *cur = text.data();
+            const char *const last = text.data() + text.size();
+
+            std::size_t count = 0;
+            while (count < out.size())
+            {
+                cur = SkipSpaces(cur, last);
+                if (cur == last)
+                    break;
+
+                std::from_chars_result result = from_chars(cur, last, out[count], style);
+                if (result.ec != std::errc{})
+                    throw std::runtime_error("Invalid vector in the text at offset " + std::to_string(cur - text.data()) + ".");
+                cur = result.ptr;
+                count++;
+            }
+
+            if (out_offset)
+                *out_offset = std::size_t(cur - text.data());
+            return count;
+        }
+    };
+
+    inline namespace Common
+    {
+        using Math::vec_text;
+        using Math::vec_text_style;
+    }
+}
+
+#ifdef __cpp_lib_format
+// Formats vectors as `(x, y, z)`. The format spec is applied to each element, e.g. `{:.2f}` gives `(1.00, 2.00)`.
+template <typename T, int N, typename CharT>
+struct std::formatter<em::Math::vec<T, N>, CharT>
+{
+    std::formatter<T, CharT> elem_formatter;
+
+    constexpr auto parse(std::basic_format_parse_context<CharT> &ctx)
+    {
+        return elem_formatter.parse(ctx);
+    }
+
+    template <typename FormatContext>
+    auto format(const em::Math::vec<T, N> &value, FormatContext &ctx) const
+    {
+        auto out = ctx.out();
+        *out++ = CharT('(');
+        for (int i = 0; i < N; i++)
+        {
+            if (i > 0)
+            {
+                *out++ = CharT(',');
+                *out++ = CharT(' ');
+            }
+            ctx.advance_to(out);
+            out = elem_formatter.format(value[i], ctx);
+        }
+        *out++ = CharT(')');
+        return out;
+    }
+};
+#endif
@@ -31,6 +31,11 @@ namespace em::Math
             // You don't need to support `N == 1`, we do this ourselves.
             //   template <int N> using change_size = ...;
         };
+
+        // Specialize this to true for the types that contain vectors and implement `apply_elementwise()` themselves (such as rects).
+        // The vectors then don't treat them as scalars in elementwise operations, and let them apply first instead (e.g. `rect + vec`).
+        template <Meta::cvref_unqualified T>
+        struct ContainsVectorsElementwise : std::false_type {};
     }
 
     // If `T` is a vector (maybe cvref-qualified), returns its base type, otherwise returns just that cvref-unqualified type.
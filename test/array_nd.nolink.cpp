@@ -0,0 +1,62 @@
+#include "em/math/array_nd.h"
+
+#include <cstdint>
+
+using tiled = em::layout_tiled<4>;
+
+// `bool` is rejected, because `std::vector<bool>` can't return references to the elements.
+template <typename T> concept ValidArray = requires{typename em::array_nd<T, 2>;};
+static_assert(ValidArray<std::uint8_t> && !ValidArray<bool>);
+
+// Indexing.
+static_assert(em::layout_row_major::mapping<3>(em::ivec3(2, 3, 4)).storage_size() == 24);
+static_assert(em::layout_row_major::mapping<3>(em::ivec3(2, 3, 4)).index(em::ivec3(1, 2, 3)) == 1 + 2 * 2 + 3 * 6);
+static_assert(tiled::mapping<2>(em::ivec2(5, 3)).storage_size() == 32); // Padded to 2x1 tiles.
+static_assert(tiled::mapping<2>(em::ivec2(5, 3)).index(em::ivec2(3, 2)) == 11);
+static_assert(tiled::mapping<2>(em::ivec2(5, 3)).index(em::ivec2(4, 1)) == 20);
+
+// Every element has a unique index, and the region iteration visits every element once with the right index.
+template <typename Layout, int N>
+constexpr bool CheckLayout(em::vec<int, N> size, em::vec<int, N> begin, em::vec<int, N> end)
+{
+    em::array_nd<int, N, Layout> arr(size);
+    int n = 0;
+    arr.for_each([&](const em::vec<int, N> &, int &elem){elem = ++n;});
+    if (n != size.prod())
+        return false;
+
+    int expected = 0;
+    arr.for_each([&](const em::vec<int, N> &pos, int &elem)
+    {
+        if (&elem != &arr[pos])
+            expected = -1000000;
+        expected += elem;
+    });
+    if (expected != n * (n + 1) / 2)
+        return false;
+
+    int count = 0;
+    arr.region(begin, end - begin).for_each([&](const em::vec<int, N> &pos, int &elem)
+    {
+        if (&elem != &arr[begin + pos])
+            count = -1000000;
+        count++;
+    });
+    return count == (end - begin).prod();
+}
+static_assert(CheckLayout<em::layout_row_major>(em::ivec2(5, 7), em::ivec2(1, 2), em::ivec2(4, 7)));
+static_assert(CheckLayout<tiled>(em::ivec2(5, 7), em::ivec2(1, 2), em::ivec2(4, 7)));
+static_assert(CheckLayout<tiled>(em::ivec3(9, 5, 6), em::ivec3(3, 0, 1), em::ivec3(9, 5, 5)));
+static_assert(CheckLayout<tiled>(em::ivec3(9, 5, 6), em::ivec3(3, 0, 1), em::ivec3(3, 5, 5))); // Empty region.
+static_assert(CheckLayout<em::layout_tiled<2>>(em::ivec4(3, 2, 3, 2), em::ivec4(1, 1, 1, 0), em::ivec4(3, 2, 2, 2)));
+
+// Views and bounds.
+static_assert([]{
+    em::array2d<int> arr(em::ivec2(4, 3), 1);
+    arr[em::ivec2(3, 2)] = 5;
+    auto v = arr.region(em::ivec2(1, 1), em::ivec2(3, 2));
+    em::array_view<const int, 2> cv = v;
+    return v.size() == em::ivec2(3, 2) && cv[em::ivec2(2, 1)] == 5 && v.at(em::ivec2(0, 0)) == 1
+        && arr.bounds_contain(em::ivec2(3, 2)) && !arr.bounds_contain(em::ivec2(4, 0)) && !arr.bounds_contain(em::ivec2(0, -1))
+        && v.bounds_contain(em::ivec2(2, 1)) && !v.bounds_contain(em::ivec2(3, 1));
+}());
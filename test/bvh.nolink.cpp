@@ -0,0 +1,122 @@
+#include "em/math/bvh.h"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+static_assert(sizeof(em::bvh<float>::node) == 32);
+
+// Boxes along the X axis, with gaps between them.
+constexpr std::array<em::frect3, 20> MakeBoxes(float offset)
+{
+    std::array<em::frect3, 20> ret;
+    for (int i = 0; i < 20; i++)
+        ret[std::size_t(i)] = em::frect3(em::fvec3(float(i * 2) + offset, 0, 0), em::fvec3(float(i * 2 + 1) + offset, 1, 1));
+    return ret;
+}
+
+// Every primitive is in exactly one leaf, and the node boxes contain their children.
+static_assert([]{
+    std::array<em::frect3, 20> boxes = MakeBoxes(0);
+    em::bvh<float> tree;
+    tree.build(boxes);
+    if (tree.size() != 20 || tree.nodes().size() < 3)
+        return false;
+
+    std::array<int, 20> seen{};
+    for (const auto &n : tree.nodes())
+    {
+        if (n.is_leaf())
+        {
+            for (std::uint32_t j = 0; j < n.count; j++)
+            {
+                std::uint32_t i = tree.indices()[n.first + j];
+                seen[i]++;
+                if (!n.bounds().contains(boxes[i]))
+                    return false;
+            }
+        }
+        else if (n.first == 0 || !n.bounds().contains(tree.nodes()[n.first].bounds()) || !n.bounds().contains(tree.nodes()[n.first + 1].bounds()))
+        {
+            return false;
+        }
+    }
+    for (int x : seen)
+    {
+        if (x != 1)
+            return false;
+    }
+    return true;
+}());
+
+// Queries, and refitting.
+static_assert([]{
+    std::array<em::frect3, 20> boxes = MakeBoxes(0);
+    em::bvh<float> tree;
+    tree.build(boxes);
+
+    // Overlaps, touching counts.
+    auto Overlapping = [&](const em::frect3 &query)
+    {
+        std::uint32_t mask = 0;
+        tree.for_each_overlapping(query, [&](std::uint32_t i)
+        {
+            if (boxes[i].expand(0.001f).overlaps(query))
+                mask |= std::uint32_t(1) << i;
+        });
+        return mask;
+    };
+    if (Overlapping(em::frect3(em::fvec3(4.5f, 0.5f, 0.5f), em::fvec3(7, 2, 2))) != 0b1100 || Overlapping(em::frect3(em::fvec3(-5), em::fvec3(-1))) != 0)
+        return false;
+
+    // The nearest ray hit.
+    auto Cast = [&](const em::ray<float> &r)
+    {
+        std::uint32_t hit = std::uint32_t(-1);
+        tree.for_each_ray_hit(em::ray_box_query(r), [&](std::uint32_t i, float &t_max)
+        {
+            float t = em::intersect_ray_box(em::ray_box_query(r, 0, t_max), boxes[i]);
+            if (t < t_max)
+            {
+                t_max = t;
+                hit = i;
+            }
+        });
+        return hit;
+    };
+    if (Cast(em::ray<float>{em::fvec3(100, 0.5f, 0.5f), em::fvec3(-1, 0, 0)}) != 19 || Cast(em::ray<float>{em::fvec3(-100, 0.5f, 0.5f), em::fvec3(1, 0, 0)}) != 0)
+        return false;
+    if (Cast(em::ray<float>{em::fvec3(10.5f, 5, 0.5f), em::fvec3(0, -1, 0)}) != 5 || Cast(em::ray<float>{em::fvec3(11.5f, 5, 0.5f), em::fvec3(0, -1, 0)}) != std::uint32_t(-1))
+        return false;
+
+    // Move everything and refit.
+    boxes = MakeBoxes(1000);
+    tree.refit(boxes);
+    return Overlapping(em::frect3(em::fvec3(1004.5f, 0.5f, 0.5f), em::fvec3(1007, 2, 2))) == 0b1100 && Cast(em::ray<float>{em::fvec3(0, 0.5f, 0.5f), em::fvec3(1, 0, 0)}) == 0;
+}());
+
+// 2D, and degenerate inputs.
+static_assert([]{
+    em::bvh<float, 2> tree;
+    tree.build({});
+    if (!tree.empty() || !tree.nodes().empty())
+        return false;
+
+    // All in the same place, more than fits in a leaf.
+    std::array<em::frect2, 20> boxes;
+    boxes.fill(em::frect2(em::fvec2(1), em::fvec2(1)));
+    tree.build(boxes);
+    int count = 0;
+    tree.for_each_overlapping(em::frect2(em::fvec2(0), em::fvec2(1)), [&](std::uint32_t){count++;});
+    if (count != 20)
+        return false;
+
+    // The centroids differ only by subnormal amounts, so the bin scale would be infinite.
+    for (std::size_t i = 0; i < boxes.size(); i++)
+        boxes[i] = em::frect2(em::fvec2(float(i) * std::numeric_limits<float>::denorm_min()), em::fvec2(float(i) * std::numeric_limits<float>::denorm_min()));
+    tree.build(boxes);
+    count = 0;
+    tree.for_each_overlapping(em::frect2(em::fvec2(0), em::fvec2(1)), [&](std::uint32_t){count++;});
+    return count == 20;
+}());
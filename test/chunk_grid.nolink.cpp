@@ -0,0 +1,69 @@
+#include "em/math/chunk_grid.h"
+
+#include <cstdint>
+
+using grid2 = em::chunk_grid<int, 16, 2>;
+using grid3 = em::chunk_grid<int, 10, 3>;
+
+// `bool` is rejected, because `std::vector<bool>` can't return references to the cells.
+template <typename T> concept ValidGrid = requires{typename em::chunk_grid<T, 16, 2>;};
+static_assert(ValidGrid<std::uint8_t> && !ValidGrid<bool>);
+
+// Splitting the coordinates, both for power-of-two and other sizes.
+static_assert(grid2::chunk_coord(em::ivec2(0, 15)) == em::ivec2(0, 0));
+static_assert(grid2::chunk_coord(em::ivec2(16, -1)) == em::ivec2(1, -1));
+static_assert(grid2::chunk_coord(em::ivec2(-16, -17)) == em::ivec2(-1, -2));
+static_assert(grid2::local_coord(em::ivec2(16, -1)) == em::ivec2(0, 15));
+static_assert(grid2::local_coord(em::ivec2(-16, -17)) == em::ivec2(0, 15));
+static_assert(grid3::chunk_coord(em::ivec3(9, 10, -1)) == em::ivec3(0, 1, -1));
+static_assert(grid3::local_coord(em::ivec3(9, 10, -1)) == em::ivec3(9, 0, 9));
+static_assert(grid3::local_index(em::ivec3(1, 2, 3)) == 321);
+static_assert(grid3::chunk_volume == 1000);
+
+static_assert([]{
+    grid3 g;
+    if (g.try_get(em::ivec3(1, 2, 3)) || g.num_chunks() != 0)
+        return false;
+
+    g[em::ivec3(1, 2, 3)] = 10;
+    g[em::ivec3(-1, -2, -3)] = 20;
+    g[em::ivec3(100, 0, 0)] = 30;
+    g[em::ivec3(5, 5, 5)] = 40; // Same chunk as the first one.
+    if (g.num_chunks() != 3)
+        return false;
+
+    if (g.get_or(em::ivec3(1, 2, 3), -1) != 10 || g.get_or(em::ivec3(-1, -2, -3), -1) != 20 || g.get_or(em::ivec3(100, 0, 0), -1) != 30)
+        return false;
+    if (g.get_or(em::ivec3(1, 1, 1), -1) != 0 || g.get_or(em::ivec3(1000, 1, 1), -1) != -1)
+        return false;
+
+    if (!g.erase_chunk(em::ivec3(0, 0, 0)) || g.erase_chunk(em::ivec3(0, 0, 0)) || g.num_chunks() != 2)
+        return false;
+    if (g.try_get(em::ivec3(1, 2, 3)) || g.get_or(em::ivec3(-1, -2, -3), -1) != 20 || g.get_or(em::ivec3(100, 0, 0), -1) != 30)
+        return false;
+
+    int sum = 0, count = 0;
+    g.for_each_cell([&](const em::ivec3 &pos, int &cell)
+    {
+        if (cell != 0 && g.get_or(pos, -1) != cell)
+            sum = -1000;
+        sum += cell;
+        count++;
+    });
+    return sum == 50 && count == 2000;
+}());
+
+// Many chunks, to test rehashing and erasing with collisions.
+static_assert([]{
+    em::chunk_grid<int, 1, 2> g;
+    for (int i = 0; i < 200; i++)
+        g[em::ivec2(i % 20 - 10, i / 20 - 5)] = i + 1;
+    for (int i = 0; i < 200; i += 2)
+        g.erase_chunk(em::ivec2(i % 20 - 10, i / 20 - 5));
+    for (int i = 0; i < 200; i++)
+    {
+        if (g.get_or(em::ivec2(i % 20 - 10, i / 20 - 5), 0) != (i % 2 ? i + 1 : 0))
+            return false;
+    }
+    return g.num_chunks() == 100;
+}());
@@ -0,0 +1,67 @@
+#include "em/math/curves.h"
+#include "em/math/vector.h"
+
+#include <array>
+
+// Degenerate curves that are actually linear, to get exact results.
+
+static_assert(em::cubic_curve<float>::from_bezier(0, 1, 2, 3)(0) == 0);
+static_assert(em::cubic_curve<float>::from_bezier(0, 1, 2, 3)(0.5f) == 1.5f);
+static_assert(em::cubic_curve<float>::from_bezier(0, 1, 2, 3)(1) == 3);
+static_assert(em::cubic_curve<float>::from_bezier(0, 1, 2, 3).derivative(0.5f) == 3);
+
+static_assert(em::cubic_curve<em::fvec2>::from_bezier(em::fvec2(0, 0), em::fvec2(1, 2), em::fvec2(2, 4), em::fvec2(3, 6))(0.5f) == em::fvec2(1.5f, 3));
+
+static_assert(em::cubic_curve<float>::from_hermite(0, 3, 3, 3)(0.5f) == 1.5f);
+static_assert(em::cubic_curve<float>::from_catmull_rom(0, 1, 2, 3)(0.5f) == 1.5f);
+
+// Passing through the control points.
+
+static_assert(em::cubic_curve<float>::from_bezier(1, 5, -7, 2)(0) == 1);
+static_assert(em::cubic_curve<float>::from_bezier(1, 5, -7, 2)(1) == 2);
+static_assert(em::cubic_curve<float>::from_hermite(1, 5, -7, 2)(0) == 1);
+static_assert(em::cubic_curve<float>::from_hermite(1, 5, -7, 2)(1) == -7);
+static_assert(em::cubic_curve<float>::from_hermite(1, 5, -7, 2).derivative(0) == 5);
+static_assert(em::cubic_curve<float>::from_hermite(1, 5, -7, 2).derivative(1) == 2);
+static_assert(em::cubic_curve<float>::from_catmull_rom(1, 5, -7, 2)(0) == 5);
+static_assert(em::cubic_curve<float>::from_catmull_rom(1, 5, -7, 2)(1) == -7);
+
+// A non-trivial value: `(1-t)^3 p0 + 3(1-t)^2 t p1 + 3(1-t) t^2 p2 + t^3 p3` at `t = 0.5` is `(p0 + 3 p1 + 3 p2 + p3) / 8`.
+static_assert(em::cubic_curve<float>::from_bezier(8, 0, 0, 0)(0.5f) == 1);
+static_assert(em::cubic_curve<float>::from_bezier(0, 8, 0, 0)(0.5f) == 3);
+
+// Batched evaluation.
+
+static_assert([]{
+    std::array<float, 3> t = {0, 0.5f, 1};
+    std::array<em::fvec2, 3> out{};
+    em::cubic_curve<em::fvec2>::from_bezier(em::fvec2(0, 0), em::fvec2(1, 2), em::fvec2(2, 4), em::fvec2(3, 6)).eval(t, out);
+    return out == std::array{em::fvec2(0, 0), em::fvec2(1.5f, 3), em::fvec2(3, 6)};
+}());
+
+// Splines.
+
+static_assert([]{
+    std::array<float, 7> points = {0, 1, 2, 3, 4, 5, 6}; // Two Bezier segments.
+    std::array<float, 6> t = {-1, 0, 0.5f, 1, 1.5f, 3};
+    std::array<float, 6> out{};
+    em::Math::eval_bezier_spline<float>(points, t, out);
+    return out == std::array<float, 6>{0, 0, 1.5f, 3, 4.5f, 6};
+}());
+
+static_assert([]{
+    std::array<float, 3> points = {0, 10, 20};
+    std::array<float, 3> tangents = {10, 10, 10};
+    std::array<float, 4> t = {0, 0.5f, 1, 1.5f};
+    std::array<float, 4> out{};
+    em::Math::eval_hermite_spline<float>(points, tangents, t, out);
+    return out == std::array<float, 4>{0, 5, 10, 15};
+}());
+
+static_assert([]{
+    std::array<float, 5> points = {0, 1, 2, 3, 4};
+    std::array<float, 3> t = {0, 0.5f, 2};
+    std::array<float, 3> out{};
+    em::Math::eval_catmull_rom_spline<float>(points, t, out);
+    return out == std::array<float, 3>{1, 1.5f, 3};
+}());
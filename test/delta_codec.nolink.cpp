@@ -0,0 +1,58 @@
+#include "em/math/delta_codec.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// Zigzag encoding.
+static_assert(em::Math::detail::DeltaCodec::ZigzagEncode(std::uint8_t(0)) == 0);
+static_assert(em::Math::detail::DeltaCodec::ZigzagEncode(std::uint8_t(-1)) == 1);
+static_assert(em::Math::detail::DeltaCodec::ZigzagEncode(std::uint8_t(1)) == 2);
+static_assert(em::Math::detail::DeltaCodec::ZigzagEncode(std::uint8_t(-128)) == 255);
+static_assert(em::Math::detail::DeltaCodec::ZigzagDecode(std::uint8_t(255)) == std::uint8_t(-128));
+static_assert(em::Math::detail::DeltaCodec::ZigzagDecode(std::uint64_t(4)) == 2);
+
+static_assert(em::delta_encoder<em::ivec2>::max_encoded_size(0) == 1);
+static_assert(em::delta_encoder<em::i16vec3>::max_encoded_size(129) == 2 + 2 * 3 + 129 * 3 * 2);
+
+// Encodes `input` in two parts, decodes it back, and checks that the result matches.
+template <typename V, std::size_t N>
+constexpr bool RoundTrip(const V (&input)[N], std::size_t split)
+{
+    em::delta_encoder<V> encoder;
+    std::byte buffer[em::delta_encoder<V>::max_encoded_size(N) * 2];
+    const std::size_t size_a = encoder.encode(std::span(input, split), buffer);
+    const std::size_t size_b = encoder.encode(std::span(input + split, N - split), std::span(buffer + size_a, sizeof buffer - size_a));
+
+    em::delta_decoder<V> decoder;
+    V output[N]{};
+    if (em::delta_decoder<V>::encoded_count(buffer) != split)
+        return false;
+    auto result_a = decoder.decode(std::span<const std::byte>(buffer, size_a), std::span(output, split));
+    auto result_b = decoder.decode(std::span<const std::byte>(buffer + size_a, size_b), std::span(output + split, N - split));
+    return result_a.num_bytes == size_a && result_b.num_bytes == size_b && result_a.count == split && result_b.count == N - split && std::equal(input, input + N, output);
+}
+
+constexpr int scalars[] = {5, -3, 1000, 1000, -2147483647 - 1, 2147483647, 0};
+static_assert(RoundTrip(scalars, 0));
+static_assert(RoundTrip(scalars, 3));
+
+constexpr em::i16vec3 small_steps[] = {{10, 20, 30}, {11, 20, 29}, {12, 21, 28}, {12, 22, 27}, {-32768, 32767, 0}};
+static_assert(RoundTrip(small_steps, 2));
+
+constexpr em::u8vec4 bytes[] = {{0, 255, 1, 254}, {255, 0, 254, 1}, {0, 0, 0, 0}};
+static_assert(RoundTrip(bytes, 1));
+
+// Blocks, and the widths that span several words.
+constexpr bool RoundTripLong()
+{
+    em::i64vec2 input[300]{};
+    std::uint64_t state = 1;
+    for (em::i64vec2 &v : input)
+    {
+        state = state * 6364136223846793005 + 1442695040888963407;
+        v = em::i64vec2(std::int64_t(state), std::int64_t(state >> 29));
+    }
+    return RoundTrip(input, 129);
+}
+static_assert(RoundTripLong());
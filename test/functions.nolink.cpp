@@ -155,3 +155,55 @@ static_assert(em::ipow(3, 2) == 9);
 static_assert(em::ipow(3, 3) == 27);
 static_assert(em::ipow(3, -1) == 1); // For now negative powers are treated as zeroes.
 static_assert(em::ipow(em::ivec2(2, 3), 2) == em::ivec2(4, 9));
+
+
+// fma
+
+static_assert(em::fma(2, 3, 4) == 10);
+static_assert(em::fma(2.f, 3.f, 4.f) == 10.f);
+static_assert(std::is_same_v<decltype(em::fma(2, 3.f, 4)), float>);
+static_assert(em::fma(em::ivec2(1, 2), 3, em::ivec2(10, 20)) == em::ivec2(13, 26));
+
+
+// lerp, inverse_lerp
+
+static_assert(em::lerp(10, 20, 0) == 10);
+static_assert(em::lerp(10, 20, 1) == 20);
+static_assert(em::lerp(10, 20, 0.5f) == 15);
+static_assert(std::is_same_v<decltype(em::lerp(10, 20, 1)), float>); // Always floating-point.
+static_assert(std::is_same_v<decltype(em::lerp(10, 20.0, 1.f)), double>);
+static_assert(em::lerp(0.1f, 0.7f, 1.f) == 0.7f); // Exact at the ends.
+static_assert(em::lerp(em::fvec2(0, 10), em::fvec2(10, 30), 0.5f) == em::fvec2(5, 20));
+static_assert(em::lerp(em::fvec2(0, 10), em::fvec2(10, 30), em::fvec2(0, 1)) == em::fvec2(0, 30));
+
+static_assert(em::inverse_lerp(10, 20, 15) == 0.5f);
+static_assert(em::inverse_lerp(10, 20, 30) == 2); // Not clamped.
+static_assert(em::inverse_lerp(em::fvec2(0, 10), em::fvec2(10, 30), em::fvec2(5, 20)) == em::fvec2(0.5f, 0.5f));
+
+
+// smoothstep, smootherstep
+
+static_assert(em::smoothstep(10, 20, 5) == 0);
+static_assert(em::smoothstep(10, 20, 10) == 0);
+static_assert(em::smoothstep(10, 20, 15) == 0.5f);
+static_assert(em::smoothstep(10, 20, 20) == 1);
+static_assert(em::smoothstep(10, 20, 25) == 1);
+static_assert(em::smoothstep(0.f, 1.f, 0.25f) == 0.15625f);
+static_assert(em::smoothstep(0, 1, em::fvec2(0.25f, 2)) == em::fvec2(0.15625f, 1));
+
+static_assert(em::smootherstep(10, 20, 5) == 0);
+static_assert(em::smootherstep(10, 20, 15) == 0.5f);
+static_assert(em::smootherstep(10, 20, 25) == 1);
+
+
+// ifloor, iceil
+
+static_assert(em::ifloor(1.5f) == 1);
+static_assert(em::ifloor(-1.5f) == -2);
+static_assert(em::ifloor(-2.f) == -2);
+static_assert(em::ifloor(em::fvec2(0.5f, -0.5f)) == em::ivec2(0, -1));
+static_assert(std::is_same_v<decltype(em::ifloor<long long>(1.5)), long long>);
+static_assert(em::iceil(1.5f) == 2);
+static_assert(em::iceil(-1.5f) == -1);
+static_assert(em::iceil(2.f) == 2);
+static_assert(em::iceil(em::fvec2(0.5f, -0.5f)) == em::ivec2(1, 0));
@@ -0,0 +1,80 @@
+#include "em/math/grid_traversal.h"
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <span>
+
+// Collects the cells visited by a traversal, and checks them against `expected`.
+template <int N>
+constexpr bool VisitsCells(const auto &range, std::span<const em::vec<int, N>> expected)
+{
+    std::size_t i = 0;
+    for (const auto &elem : range)
+    {
+        em::vec<int, N> cell;
+        if constexpr (requires{elem.cell;})
+            cell = elem.cell;
+        else
+            cell = elem;
+        if (i >= expected.size() || cell != expected[i])
+            return false;
+        i++;
+    }
+    return i == expected.size();
+}
+
+// Voxel traversal.
+static_assert([]{
+    std::array<em::ivec2, 4> cells = {em::ivec2(0, 0), em::ivec2(1, 0), em::ivec2(2, 0), em::ivec2(3, 0)};
+    return VisitsCells<2>(em::voxel_traversal<float, 2>(em::ray<float, 2>{em::fvec2(0.5f), em::fvec2(1, 0)}, 0, 3), cells);
+}());
+static_assert([]{
+    // Starting on a boundary and moving away from it, the end point is on a boundary too.
+    std::array<em::ivec2, 2> cells = {em::ivec2(0, 0), em::ivec2(-1, 0)};
+    return VisitsCells<2>(em::voxel_traversal<float, 2>::segment(em::fvec2(1, 0.5f), em::fvec2(-1, 0.5f)), cells);
+}());
+static_assert([]{
+    // Exactly through a corner.
+    std::array<em::ivec2, 3> cells = {em::ivec2(0, 0), em::ivec2(1, 0), em::ivec2(1, 1)};
+    return VisitsCells<2>(em::voxel_traversal<float, 2>::segment(em::fvec2(0.5f), em::fvec2(1.5f)), cells);
+}());
+static_assert([]{
+    // Larger cells, negative coordinates, and the distances.
+    std::array<em::ivec3, 3> cells = {em::ivec3(-1, -2, 0), em::ivec3(-1, -1, 0), em::ivec3(-1, 0, 0)};
+    auto range = em::voxel_traversal<float, 3>::segment(em::fvec3(-1, -3, 1), em::fvec3(-1, 1, 1), 2);
+    if (!VisitsCells<3>(range, cells))
+        return false;
+    auto it = range.begin();
+    ++it;
+    return it->t_enter == 0.25f && it->t_exit == 0.75f;
+}());
+static_assert([]{
+    // A zero direction, and infinite distance.
+    std::array<em::ivec2, 1> cells = {em::ivec2(0, 0)};
+    return VisitsCells<2>(em::voxel_traversal<float, 2>(em::ray<float, 2>{em::fvec2(0.5f), em::fvec2(0)}, 0, std::numeric_limits<float>::infinity()), cells);
+}());
+static_assert([]{
+    std::array<em::ray<float, 2>, 2> rays = {em::ray<float, 2>{em::fvec2(0.5f), em::fvec2(1, 0)}, em::ray<float, 2>{em::fvec2(0.5f), em::fvec2(0, -1)}};
+    int sum = 0;
+    em::voxel_traversal<float, 2>::for_each_batch(rays, 0, 10, 1, [&](std::size_t i, const em::voxel_traversal_cell<float, 2> &c)
+    {
+        sum += c.cell.x + c.cell.y * 100;
+        return i == 0 || c.cell.y > -3; // Stop the second ray early.
+    });
+    return sum == (1 + 2 + 3 + 4 + 5 + 6 + 7 + 8 + 9 + 10) - 100 * (1 + 2 + 3);
+}());
+
+// Bresenham lines.
+static_assert([]{
+    std::array<em::ivec2, 6> cells = {em::ivec2(0, 0), em::ivec2(1, 0), em::ivec2(2, 1), em::ivec2(3, 1), em::ivec2(4, 2), em::ivec2(5, 2)};
+    return VisitsCells<2>(em::bresenham_line(em::ivec2(0, 0), em::ivec2(5, 2)), cells);
+}());
+static_assert([]{
+    std::array<em::ivec2, 6> cells = {em::ivec2(0, 0), em::ivec2(0, -1), em::ivec2(-1, -2), em::ivec2(-1, -3), em::ivec2(-2, -4), em::ivec2(-2, -5)};
+    return VisitsCells<2>(em::bresenham_line(em::ivec2(0, 0), em::ivec2(-2, -5)), cells);
+}());
+static_assert([]{
+    std::array<em::ivec2, 1> cells = {em::ivec2(3, 3)};
+    return VisitsCells<2>(em::bresenham_line(em::ivec2(3, 3), em::ivec2(3, 3)), cells);
+}());
@@ -0,0 +1,113 @@
+#include "em/math/kd_tree.h"
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+// A 5x5 grid of points with the step 1, in the order `x + y * 5`.
+constexpr std::array<em::fvec2, 25> MakeGrid()
+{
+    std::array<em::fvec2, 25> ret;
+    for (int i = 0; i < 25; i++)
+        ret[std::size_t(i)] = em::fvec2(float(i % 5), float(i / 5));
+    return ret;
+}
+
+// The leaves cover every point exactly once.
+static_assert([]{
+    std::array<em::fvec2, 25> points = MakeGrid();
+    em::kd_tree<float, 2> tree;
+    tree.build(points);
+    if (tree.size() != 25 || tree.nodes().size() < 3)
+        return false;
+
+    std::array<int, 25> seen{};
+    for (const auto &n : tree.nodes())
+    {
+        if (n.is_leaf())
+        {
+            if (n.count > tree.max_leaf_size)
+                return false;
+            for (std::uint32_t i = n.first; i < n.first + n.count; i++)
+            {
+                seen[tree.indices()[i]]++;
+                if (tree.points()[i] != points[tree.indices()[i]])
+                    return false;
+            }
+        }
+    }
+    for (int x : seen)
+    {
+        if (x != 1)
+            return false;
+    }
+    return true;
+}());
+
+// Nearest neighbors.
+static_assert([]{
+    std::array<em::fvec2, 25> points = MakeGrid();
+    em::kd_tree<float, 2> tree;
+    tree.build(points);
+
+    std::array<em::kd_tree_neighbor<float>, 3> out{};
+    if (tree.find_nearest(em::fvec2(3.1f, 1.2f), out) != 3 || out[0].index != 8 || out[1].index != 13 || out[2].index != 9)
+        return false;
+    if (out[0].dist_sq != em::distance_sq(em::fvec2(3.1f, 1.2f), em::fvec2(3, 1)))
+        return false;
+    // Limited by the distance.
+    if (tree.find_nearest(em::fvec2(3.1f, 1.2f), out, 0.7f) != 2 || tree.find_nearest(em::fvec2(-5, 0), out, 1) != 0)
+        return false;
+
+    // In batches.
+    std::array<em::fvec2, 2> queries = {em::fvec2(0), em::fvec2(4.4f, 4.4f)};
+    std::array<em::kd_tree_neighbor<float>, 4> batch_out{};
+    std::array<std::uint32_t, 2> batch_counts{};
+    tree.find_nearest_batch(queries, 2, batch_out, batch_counts);
+    return batch_counts == std::array<std::uint32_t, 2>{2, 2} && batch_out[0] == em::kd_tree_neighbor<float>{0, 0} && batch_out[2].index == 24;
+}());
+
+// With `k == 0` nothing is written to `out`, so it can be empty.
+static_assert([]{
+    std::array<em::fvec2, 25> points = MakeGrid();
+    em::kd_tree<float, 2> tree;
+    tree.build(points);
+    std::array<em::fvec2, 2> queries = {em::fvec2(0), em::fvec2(1)};
+    std::array<std::uint32_t, 2> counts = {7, 7};
+    tree.find_nearest_batch(queries, 0, {}, counts);
+    return counts == std::array<std::uint32_t, 2>{0, 0};
+}());
+
+// Radius queries.
+static_assert([]{
+    std::array<em::fvec2, 25> points = MakeGrid();
+    em::kd_tree<float, 2> tree;
+    tree.build(points);
+
+    // A circle of radius 1 around a grid point has 5 grid points, including the boundary.
+    int count = 0;
+    std::uint32_t mask = 0;
+    tree.for_each_within(em::fvec2(2, 2), 1, [&](std::uint32_t i, float d)
+    {
+        count++;
+        mask |= std::uint32_t(1) << i;
+        if (d != em::distance_sq(em::fvec2(2, 2), points[i]))
+            count = -100;
+    });
+    return count == 5 && mask == (1u << 7 | 1u << 11 | 1u << 12 | 1u << 13 | 1u << 17);
+}());
+
+// 3D, duplicates, and empty trees.
+static_assert([]{
+    em::kd_tree<double> tree;
+    tree.build({});
+    std::array<em::kd_tree_neighbor<double>, 1> out{};
+    if (!tree.empty() || tree.find_nearest(em::dvec3(0), out) != 0)
+        return false;
+
+    std::array<em::dvec3, 20> points;
+    points.fill(em::dvec3(1, 2, 3));
+    points[13] = em::dvec3(0, 2, 3);
+    tree.build(points);
+    return tree.find_nearest(em::dvec3(-1, 2, 3), out) == 1 && out[0] == em::kd_tree_neighbor<double>{13, 1};
+}());
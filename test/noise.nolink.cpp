@@ -0,0 +1,74 @@
+#include "em/math/noise.h"
+
+#include <array>
+
+namespace
+{
+    constexpr bool Near(double a, double b) {return a - b < 1e-12 && b - a < 1e-12;}
+}
+
+// Deterministic output.
+static_assert(Near(em::perlin_noise(em::dvec2(0.3, 1.7)), 0.62995649136000009));
+static_assert(Near(em::perlin_noise(em::dvec3(0.3, 1.7, -2.2)), -0.061238171295436863));
+static_assert(Near(em::perlin_noise(em::dvec4(0.3, 1.7, -2.2, 5.9), 7), -0.30962025868559745));
+static_assert(Near(em::simplex_noise(em::dvec2(0.3, 1.7)), -0.12976647515370499));
+static_assert(Near(em::simplex_noise(em::dvec3(0.3, 1.7, -2.2)), 0.12603735664197571));
+static_assert(Near(em::simplex_noise(em::dvec4(0.3, 1.7, -2.2, 5.9), 7), 0.0012416367561916297));
+
+// Perlin noise is zero at integer points.
+static_assert(em::perlin_noise(em::fvec2(3, -4)) == 0);
+static_assert(em::perlin_noise(em::fvec3(3, -4, 5)) == 0);
+static_assert(em::perlin_noise(em::fvec4(3, -4, 5, -6)) == 0);
+
+// Seeds matter.
+static_assert(em::perlin_noise(em::fvec3(0.5f, 0.5f, 0.5f), 1) != em::perlin_noise(em::fvec3(0.5f, 0.5f, 0.5f), 2));
+static_assert(em::simplex_noise(em::fvec3(0.5f, 0.5f, 0.5f), 1) != em::simplex_noise(em::fvec3(0.5f, 0.5f, 0.5f), 2));
+
+// The range.
+static_assert([]{
+    for (int i = 0; i < 500; i++)
+    {
+        em::fvec3 p(float(i) * 0.37f - 90, float(i % 17) * 1.3f, float(i % 5) * -2.1f);
+        float a = em::perlin_noise(p), b = em::simplex_noise(p);
+        if (a < -1.1f || a > 1.1f || b < -1.1f || b > 1.1f)
+            return false;
+    }
+    return true;
+}());
+
+// FBM with one octave is the same as the underlying noise.
+static_assert(em::fbm_noise(em::perlin_noise, em::fvec2(0.3f, 1.7f), {.octaves = 1}) == em::perlin_noise(em::fvec2(0.3f, 1.7f)));
+
+// Batching.
+static_assert([]{
+    std::array<em::fvec2, 3> points = {em::fvec2(0.1f, 0.2f), em::fvec2(-5.3f, 1), em::fvec2(100.5f, -7.25f)};
+    std::array<float, 3> out{};
+    em::Math::eval_noise(em::simplex_noise, std::span<const em::fvec2>(points), std::span(out));
+    for (std::size_t i = 0; i < points.size(); i++)
+    {
+        if (out[i] != em::simplex_noise(points[i]))
+            return false;
+    }
+    return true;
+}());
+
+static_assert([]{
+    std::array<float, 3 * 2 * 2> out{};
+    em::fvec3 origin(-1, 2, 3), step(0.25f, 0.5f, 2);
+    em::Math::eval_noise_grid(em::perlin_noise, origin, step, em::ivec3(3, 2, 2), std::span(out));
+    std::size_t i = 0;
+    for (int z = 0; z < 2; z++)
+    for (int y = 0; y < 2; y++)
+    for (int x = 0; x < 3; x++)
+    {
+        if (out[i++] != em::perlin_noise(em::fvec3(-1 + 0.25f * float(x), 2 + 0.5f * float(y), 3 + 2 * float(z))))
+            return false;
+    }
+    return true;
+}());
+
+// An empty grid doesn't need any output.
+static_assert([]{
+    em::Math::eval_noise_grid(em::perlin_noise, em::fvec2(0), em::fvec2(1), em::ivec2(70000, 0), std::span<float>());
+    return true;
+}());
@@ -0,0 +1,47 @@
+#include "em/math/polygon.h"
+
+#include <array>
+
+using ipolygon = em::polygon_2d<int>;
+
+// Convex hulls skip the interior points, the points on the edges, and the duplicates.
+static_assert([]{
+    std::array<em::ivec2, 7> points = {em::ivec2(0,0), em::ivec2(2,0), em::ivec2(1,1), em::ivec2(2,2), em::ivec2(0,2), em::ivec2(1,0), em::ivec2(2,2)};
+    std::array<em::ivec2, 8> out{};
+    auto hull = ipolygon::convex_hull(points, out, 1);
+    return hull.size() == 4 && hull[0] == em::ivec2(0,0) && hull[1] == em::ivec2(2,0) && hull[2] == em::ivec2(2,2) && hull[3] == em::ivec2(0,2);
+}());
+static_assert([]{
+    std::array<em::ivec2, 3> points = {em::ivec2(1,1), em::ivec2(1,1), em::ivec2(1,1)};
+    std::array<em::ivec2, 4> out{};
+    return ipolygon::convex_hull(points, out, 1).size() == 1;
+}());
+static_assert([]{
+    std::array<em::ivec2, 3> points = {em::ivec2(2,2), em::ivec2(0,0), em::ivec2(1,1)};
+    std::array<em::ivec2, 4> out{};
+    auto hull = ipolygon::convex_hull(points, out, 1);
+    return hull.size() == 2 && hull[0] == em::ivec2(0,0) && hull[1] == em::ivec2(2,2);
+}());
+
+// Areas and centroids.
+constexpr std::array<em::ivec2, 4> rect_ccw = {em::ivec2(0,0), em::ivec2(4,0), em::ivec2(4,2), em::ivec2(0,2)};
+constexpr std::array<em::ivec2, 4> rect_cw = {em::ivec2(0,0), em::ivec2(0,2), em::ivec2(4,2), em::ivec2(4,0)};
+static_assert(ipolygon::signed_area(rect_ccw) == 8);
+static_assert(ipolygon::signed_area(rect_cw) == -8);
+static_assert(ipolygon::orientation(rect_ccw) == 1);
+static_assert(ipolygon::orientation(rect_cw) == -1);
+static_assert(ipolygon::centroid(rect_ccw) == em::dvec2(2, 1));
+static_assert(ipolygon::centroid(rect_cw) == em::dvec2(2, 1));
+static_assert(em::polygon_2d<float>::centroid(std::array{em::fvec2(0,0), em::fvec2(3,0), em::fvec2(0,3)}) == em::fvec2(1, 1));
+
+// Point in polygon.
+static_assert(ipolygon::winding_number(rect_ccw, em::ivec2(1,1)) == 1);
+static_assert(ipolygon::winding_number(rect_cw, em::ivec2(1,1)) == -1);
+static_assert(ipolygon::winding_number(rect_ccw, em::ivec2(5,1)) == 0);
+static_assert(ipolygon::winding_number(rect_ccw, em::ivec2(1,3)) == 0);
+static_assert([]{
+    constexpr std::array<em::ivec2, 3> points = {em::ivec2(1,1), em::ivec2(-1,1), em::ivec2(3,1)};
+    std::array<bool, 3> out{};
+    ipolygon::contains_batch(rect_ccw, points, out, 1);
+    return out == std::array{true, false, true};
+}());
@@ -0,0 +1,30 @@
+#include "em/math/quat.h"
+
+#include <type_traits>
+
+using fquat = em::quat<float>;
+
+// Multiplication: `i * j == k`, and the identity.
+static_assert(fquat(1,0,0,0) * fquat(0,1,0,0) == fquat(0,0,1,0));
+static_assert(fquat(0,1,0,0) * fquat(1,0,0,0) == fquat(0,0,-1,0));
+static_assert(fquat() * fquat(1,2,3,4) == fquat(1,2,3,4));
+static_assert(fquat(1,2,3,4).conjugate() == fquat(-1,-2,-3,4));
+static_assert(fquat(0,0,0,2).inverse() == fquat(0,0,0,0.5f));
+
+// Promotion.
+static_assert(std::is_same_v<decltype(fquat() * em::quat<double>()), em::quat<double>>);
+static_assert(std::is_same_v<em::larger_t<fquat, em::quat<double>>, em::quat<double>>);
+static_assert(std::is_convertible_v<fquat, em::quat<double>>);
+static_assert(!std::is_convertible_v<em::quat<double>, fquat>);
+
+// Rotations, 180 degrees around Z.
+static_assert(fquat(0,0,1,0).rotate(em::fvec3(1,2,3)) == em::fvec3(-1,-2,3));
+static_assert(fquat(0,0,1,0).to_mat3().x == em::fvec3(-1,0,0));
+static_assert(fquat(0,0,1,0).to_mat3().y == em::fvec3(0,-1,0));
+static_assert(fquat(0,0,1,0).to_mat3().z == em::fvec3(0,0,1));
+static_assert(fquat::from_mat3(fquat(0,0,1,0).to_mat3()) == fquat(0,0,1,0));
+static_assert(fquat::from_mat3(fquat().to_mat3()) == fquat());
+
+// Interpolation takes the shortest path, `q` and `-q` are the same rotation.
+static_assert(em::nlerp(fquat(), fquat(0,0,0,-1), 0.5f) == fquat());
+static_assert(em::slerp_fast(fquat(), fquat(0,0,0,-1), 0.5f) == fquat());
@@ -0,0 +1,48 @@
+#include "em/math/radix_sort.h"
+#include "em/math/vector.h"
+
+#include <array>
+#include <limits>
+
+// Signed keys, stability, and pairs.
+static_assert([]{
+    em::radix_sorter<int> sorter;
+    std::array<int, 7> keys = {5, -3, std::numeric_limits<int>::max(), 7, -3, 0, std::numeric_limits<int>::min()};
+    std::array<char, 7> values = {'a', 'b', 'c', 'd', 'e', 'f', 'g'};
+    sorter.sort_pairs(std::span(keys), std::span<char>(values));
+    return keys == std::array<int, 7>{std::numeric_limits<int>::min(), -3, -3, 0, 5, 7, std::numeric_limits<int>::max()}
+        && values == std::array<char, 7>{'g', 'b', 'e', 'f', 'a', 'd', 'c'};
+}());
+
+// Floating-point keys, and the permutation.
+static_assert([]{
+    em::radix_sorter<float> sorter;
+    std::array<float, 6> keys = {1.5f, -0.f, -std::numeric_limits<float>::infinity(), 0.f, -2.25f, 1e30f};
+    std::array<std::uint32_t, 6> perm{};
+    sorter.sort_permutation(keys, perm);
+    return perm == std::array<std::uint32_t, 6>{2, 4, 1, 3, 0, 5};
+}());
+
+// Sorting vectors by a key, both in place and not. Reusing the sorter.
+static_assert([]{
+    em::radix_sorter<std::uint64_t> sorter;
+    std::array<em::ivec2, 5> points = {em::ivec2(3, 1), em::ivec2(0, 0), em::ivec2(1, 1), em::ivec2(200, 1), em::ivec2(2, 0)};
+    auto key = [](const em::ivec2 &p){return std::uint64_t(p.y) << 32 | std::uint64_t(p.x);};
+
+    std::array<em::ivec2, 5> sorted{};
+    sorter.sort_by_key(std::span<const em::ivec2>(points), std::span<em::ivec2>(sorted), key);
+    if (sorted != std::array<em::ivec2, 5>{em::ivec2(0, 0), em::ivec2(2, 0), em::ivec2(1, 1), em::ivec2(3, 1), em::ivec2(200, 1)})
+        return false;
+
+    sorter.sort_by_key(std::span<em::ivec2>(points), key);
+    return points == sorted;
+}());
+
+// Empty input.
+static_assert([]{
+    em::radix_sorter<unsigned char> sorter;
+    std::array<unsigned char, 0> keys{};
+    std::array<int, 0> values{};
+    sorter.sort_pairs(std::span(keys), std::span<int>(values));
+    return true;
+}());
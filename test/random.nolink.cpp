@@ -0,0 +1,87 @@
+#include "em/math/random.h"
+
+#include <array>
+#include <random>
+
+static_assert(std::uniform_random_bit_generator<em::random_generator<>>);
+static_assert(std::uniform_random_bit_generator<em::random_generator<1>>);
+
+// Reproducibility.
+static_assert(em::random_generator<>(42)() == em::random_generator<>(42)());
+static_assert(em::random_generator<>(42)() != em::random_generator<>(43)());
+static_assert(em::random_generator<>(42, 0)() != em::random_generator<>(42, 1)());
+
+// Same output regardless of how the numbers are consumed.
+static_assert([]{
+    em::random_generator<4> a(1), b(1);
+    std::array<std::uint32_t, 19> x{}, y{};
+    (void)a();
+    (void)b();
+    a.fill(x);
+    for (auto &elem : y)
+        elem = b();
+    return x == y && a() == b();
+}());
+
+static_assert([]{
+    em::random_generator<> a(1), b(1);
+    std::array<float, 100> x{}, y{};
+    a.fill_uniform<float>(x, 10, 20);
+    for (auto &elem : y)
+        elem = b.uniform(10.f, 20.f);
+    return x == y;
+}());
+
+// Ranges.
+static_assert([]{
+    em::random_generator<> r(1);
+    for (int i = 0; i < 1000; i++)
+    {
+        float f = r.uniform<float>();
+        if (f < 0 || f >= 1)
+            return false;
+        double d = r.uniform<double>();
+        if (d < 0 || d >= 1)
+            return false;
+    }
+    return true;
+}());
+
+static_assert([]{
+    em::random_generator<> r(1);
+    bool seen[7]{};
+    for (int i = 0; i < 1000; i++)
+    {
+        int x = r.uniform(-3, 3);
+        if (x < -3 || x > 3)
+            return false;
+        seen[x + 3] = true;
+        if (r.uniform(5, 5) != 5)
+            return false;
+        long long y = r.uniform(-3ll, 3ll);
+        if (y < -3 || y > 3)
+            return false;
+        std::uint8_t z = r.uniform<std::uint8_t>(250, 255);
+        if (z < 250)
+            return false;
+    }
+    for (bool b : seen)
+    {
+        if (!b)
+            return false;
+    }
+    return true;
+}());
+
+static_assert([]{
+    em::random_generator<> r(1);
+    for (int i = 0; i < 1000; i++)
+    {
+        em::ivec3 v = r.uniform(em::ivec3(-1, 0, 10), em::ivec3(1, 0, 20));
+        if (v.x < -1 || v.x > 1 || v.y != 0 || v.z < 10 || v.z > 20)
+            return false;
+        if (em::length_sq(r.in_unit_disk()) >= 1 || em::length_sq(r.in_unit_ball<double>()) >= 1)
+            return false;
+    }
+    return true;
+}());
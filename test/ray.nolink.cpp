@@ -0,0 +1,46 @@
+#include "em/math/ray.h"
+
+#include <array>
+#include <limits>
+#include <span>
+
+constexpr float inf = std::numeric_limits<float>::infinity();
+constexpr em::frect3 box(em::fvec3(0), em::fvec3(1));
+
+// The slab test.
+static_assert(em::ray<float>{em::fvec3(1, 2, 3), em::fvec3(1, 0, -1)}.at(2) == em::fvec3(3, 2, 1));
+static_assert(em::intersect_ray_box(em::ray_box_query(em::ray<float>{em::fvec3(-1, 0.5f, 0.5f), em::fvec3(1, 0, 0)}), box) == 1);
+static_assert(em::intersect_ray_box(em::ray_box_query(em::ray<float>{em::fvec3(2, 0.5f, 0.5f), em::fvec3(-1, 0, 0)}), box) == 1);
+static_assert(em::intersect_ray_box(em::ray_box_query(em::ray<float>{em::fvec3(2, 0.5f, 0.5f), em::fvec3(1, 0, 0)}), box) == inf);
+static_assert(em::intersect_ray_box(em::ray_box_query(em::ray<float>{em::fvec3(0.5f), em::fvec3(1, 0, 0)}), box) == 0); // Starting inside.
+static_assert(em::intersect_ray_box(em::ray_box_query(em::ray<float>{em::fvec3(-1, 2, 0.5f), em::fvec3(1, 0, 0)}), box) == inf);
+static_assert(em::intersect_ray_box(em::ray_box_query(em::ray<float>{em::fvec3(-1, 0.5f, 0.5f), em::fvec3(1, 0, 0)}, 0, 0.5f), box) == inf);
+// Lying in the plane of a face, with zero direction components of both signs.
+static_assert(em::intersect_ray_box(em::ray_box_query(em::ray<float>{em::fvec3(-1, 0, 0.5f), em::fvec3(1, 0, 0)}), box) == 1);
+static_assert(em::intersect_ray_box(em::ray_box_query(em::ray<float>{em::fvec3(-1, 1, 0.5f), em::fvec3(1, -0.f, 0)}), box) == 1);
+
+// Box packets.
+static_assert([]{
+    em::box_packet<float, 4> boxes;
+    boxes.set(0, box);
+    boxes.set(2, em::frect3(em::fvec3(3, 0, 0), em::fvec3(4, 1, 1)));
+    return em::intersect_ray_box_packet(em::ray_box_query(em::ray<float>{em::fvec3(-1, 0.5f, 0.5f), em::fvec3(1, 0, 0)}), boxes) == std::array<float, 4>{1, inf, 4, inf};
+}());
+
+// Triangles.
+static_assert([]{
+    em::ray_triangle_hit<float> hit = em::intersect_ray_triangle(em::ray<float>{em::fvec3(0.25f, 0.25f, -1), em::fvec3(0, 0, 1)}, em::fvec3(0, 0, 0), em::fvec3(1, 0, 0), em::fvec3(0, 1, 0));
+    return hit && hit.t == 1 && hit.u == 0.25f && hit.v == 0.25f;
+}());
+static_assert(!em::intersect_ray_triangle(em::ray<float>{em::fvec3(0.75f, 0.75f, -1), em::fvec3(0, 0, 1)}, em::fvec3(0, 0, 0), em::fvec3(1, 0, 0), em::fvec3(0, 1, 0)));
+static_assert(!em::intersect_ray_triangle(em::ray<float>{em::fvec3(0.25f, 0.25f, -1), em::fvec3(1, 0, 0)}, em::fvec3(0, 0, 0), em::fvec3(1, 0, 0), em::fvec3(0, 1, 0))); // Parallel.
+
+// Triangle packets, the nearest hit wins.
+static_assert([]{
+    std::array<em::triangle_packet<float, 4>, 2> packets{};
+    packets[0].set(1, em::fvec3(0, 0, 5), em::fvec3(1, 0, 5), em::fvec3(0, 1, 5));
+    packets[1].set(3, em::fvec3(0, 0, 2), em::fvec3(1, 0, 2), em::fvec3(0, 1, 2));
+    packets[1].set(0, em::fvec3(0, 0, -3), em::fvec3(1, 0, -3), em::fvec3(0, 1, -3)); // Behind the ray.
+    em::ray_triangle_hit<float> hit = em::intersect_ray_triangles(em::ray<float>{em::fvec3(0.25f, 0.25f, 0), em::fvec3(0, 0, 1)}, std::span<const em::triangle_packet<float, 4>>(packets));
+    return hit.index == 7 && hit.t == 2;
+}());
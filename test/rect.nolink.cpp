@@ -0,0 +1,84 @@
+#include "em/math/rect.h"
+
+#include <array>
+#include <type_traits>
+
+// Typedefs and elementwise operations.
+static_assert(std::is_same_v<em::irect2, em::rect<int, 2>>);
+static_assert(std::is_same_v<em::frect<3>, em::rect<float, 3>>);
+static_assert(em::irect2(em::ivec2(1, 2), em::ivec2(3, 4)) == em::irect2(em::ivec2(1, 2), em::ivec2(3, 4)));
+static_assert(em::irect2(em::ivec2(1, 2), em::ivec2(3, 4)) != em::irect2(em::ivec2(1, 2), em::ivec2(3, 5)));
+static_assert(em::irect2(em::ivec2(1, 2), em::ivec2(3, 4)) + em::ivec2(10, 20) == em::irect2(em::ivec2(11, 22), em::ivec2(13, 24)));
+static_assert(em::irect2(em::ivec2(1, 2), em::ivec2(3, 4)) * 2 == em::irect2(em::ivec2(2, 4), em::ivec2(6, 8)));
+static_assert(std::is_same_v<decltype(em::irect2{} * 2.f), em::frect2>);
+static_assert(em::irect2::from_pos_size(em::ivec2(1, 2), em::ivec2(3, 4)) == em::irect2(em::ivec2(1, 2), em::ivec2(4, 6)));
+static_assert(em::irect2(em::ivec2(1, 2), em::ivec2(4, 6)).size() == em::ivec2(3, 4));
+
+// Queries.
+constexpr em::irect2 r(em::ivec2(0, 0), em::ivec2(10, 5));
+static_assert(!r.empty() && em::irect2(em::ivec2(1, 1), em::ivec2(1, 5)).empty() && em::irect2(em::ivec2(2, 1), em::ivec2(1, 5)).empty());
+static_assert(r.contains(em::ivec2(0, 0)) && r.contains(em::ivec2(9, 4)) && !r.contains(em::ivec2(10, 4)) && !r.contains(em::ivec2(-1, 0)));
+static_assert(r.contains(em::irect2(em::ivec2(1, 1), em::ivec2(10, 5))) && !r.contains(em::irect2(em::ivec2(1, 1), em::ivec2(11, 5))));
+static_assert(r.contains(em::irect2(em::ivec2(100, 100), em::ivec2(100, 200)))); // Empty.
+static_assert(r.overlaps(em::irect2(em::ivec2(9, 4), em::ivec2(20, 20))) && !r.overlaps(em::irect2(em::ivec2(10, 0), em::ivec2(20, 20))));
+static_assert(!r.overlaps(em::irect2(em::ivec2(5, 2), em::ivec2(5, 3)))); // Empty rects overlap nothing.
+static_assert(r.intersect(em::irect2(em::ivec2(5, -5), em::ivec2(20, 3))) == em::irect2(em::ivec2(5, 0), em::ivec2(10, 3)));
+static_assert(r.unite(em::irect2(em::ivec2(5, -5), em::ivec2(20, 3))) == em::irect2(em::ivec2(0, -5), em::ivec2(20, 5)));
+static_assert(r.expand(1) == em::irect2(em::ivec2(-1, -1), em::ivec2(11, 6)));
+static_assert(r.expand(em::ivec2(1, -1)) == em::irect2(em::ivec2(-1, 1), em::ivec2(11, 4)));
+static_assert(r.expand_to_contain(em::ivec2(10, -2)) == em::irect2(em::ivec2(0, -2), em::ivec2(11, 5)));
+static_assert(em::frect2(em::fvec2(0), em::fvec2(1)).expand_to_contain(em::fvec2(2, 0.5f)) == em::frect2(em::fvec2(0), em::fvec2(2, 1)));
+
+// Iteration.
+static_assert([]{
+    int count = 0, sum = 0;
+    em::ivec3 last;
+    for (em::ivec3 p : em::irect3(em::ivec3(1, 2, 3), em::ivec3(3, 5, 7)))
+    {
+        count++;
+        sum += p.x + p.y * 10 + p.z * 100;
+        last = p;
+    }
+    return count == 2 * 3 * 4 && last == em::ivec3(2, 4, 6) && sum == 12 * (1 + 2) + 8 * (20 + 30 + 40) + 6 * (300 + 400 + 500 + 600);
+}());
+static_assert([]{
+    for (em::ivec2 p : em::irect2(em::ivec2(1, 2), em::ivec2(1, 5)))
+        return (void)p, false;
+    for (em::ivec2 p : em::irect2(em::ivec2(1, 2), em::ivec2(5, 2)))
+        return (void)p, false;
+    return true;
+}());
+
+// Batch queries.
+static_assert([]{
+    std::array<em::irect2, 4> rects = {
+        em::irect2(em::ivec2(0, 0), em::ivec2(2, 2)),
+        em::irect2(em::ivec2(5, 5), em::ivec2(6, 6)),
+        em::irect2(em::ivec2(1, 1), em::ivec2(1, 9)),
+        em::irect2(em::ivec2(-5, 1), em::ivec2(9, 2)),
+    };
+    em::irect2 query(em::ivec2(1, 1), em::ivec2(4, 4));
+
+    std::array<bool, 4> mask{};
+    em::rect_overlap_mask(query, rects, mask);
+    if (mask != std::array<bool, 4>{true, false, false, true})
+        return false;
+
+    std::array<std::uint32_t, 4> indices{};
+    if (em::rect_overlap_indices(query, rects, indices) != 2 || indices[0] != 0 || indices[1] != 3)
+        return false;
+
+    // Same in the structure-of-arrays form.
+    std::array<int, 4> ax{}, ay{}, bx{}, by{};
+    for (std::size_t i = 0; i < 4; i++)
+    {
+        ax[i] = rects[i].a.x;
+        ay[i] = rects[i].a.y;
+        bx[i] = rects[i].b.x;
+        by[i] = rects[i].b.y;
+    }
+    em::rect_soa_view<int, 2> soa{{ax, ay}, {bx, by}};
+    std::array<bool, 4> soa_mask{};
+    em::rect_overlap_mask(query, soa, soa_mask);
+    return soa_mask == mask && em::rect_overlap_indices(query, soa, indices) == 2 && indices[1] == 3;
+}());
@@ -1,6 +1,8 @@
 #include "em/math/robust.h"
 #include "em/math/vector.h"
 
+#include <cstdint>
+
 // Sanity check of the basic functions:
 
 static_assert( em::Math::Robust::equal        (10, 10));
@@ -161,3 +163,32 @@ static_assert(!em::Math::Robust::representable_as<em::ivec2>(em::fvec2(1.2f, 2.1
 
 static_assert(em::Math::Robust::representable_as<em::ivec2>(1.f));
 static_assert(!em::Math::Robust::representable_as<em::ivec2>(1.2f));
+
+// Checked arithmetic:
+static_assert(em::Math::Robust::checked_add(1, 2) == em::Math::Robust::checked_result<int>{3, false});
+static_assert(em::Math::Robust::checked_add(std::int8_t(100), std::int8_t(100)) == em::Math::Robust::checked_result<std::int8_t>{-56, true});
+static_assert(em::Math::Robust::checked_sub(0u, 1u).overflow);
+static_assert(em::Math::Robust::checked_mul(std::int16_t(300), std::int16_t(300)).overflow);
+static_assert(em::Math::Robust::checked_neg(std::int8_t(-128)).overflow);
+static_assert(!em::Math::Robust::checked_neg(std::int8_t(-127)).overflow);
+
+static_assert(em::Math::Robust::checked_add_or(std::int8_t(100), std::int8_t(100), std::int8_t(127)) == 127);
+static_assert(em::Math::Robust::checked_sub_or(5u, 6u, 0u) == 0u);
+
+// With vectors:
+static_assert(em::Math::Robust::checked_add(em::ivec2(1, 0x7fffffff), em::ivec2(1, 1)).overflow == em::bvec2(false, true));
+static_assert(em::Math::Robust::checked_add(em::ivec2(1, 0x7fffffff), em::ivec2(1, 1)).any_overflow());
+static_assert(!em::Math::Robust::checked_mul(em::ivec2(1, 2), 3).any_overflow());
+static_assert(em::Math::Robust::checked_add_or(em::ivec2(1, 0x7fffffff), em::ivec2(1, 1), 0) == em::ivec2(2, 0));
+
+// With spans:
+static_assert([]{
+    const int a[] = {1, 2, 3}, b[] = {4, 5, 6};
+    int out[3]{};
+    return !em::Math::Robust::checked_batch<int>::add(a, b, out) && out[0] == 5 && out[1] == 7 && out[2] == 9;
+}());
+static_assert([]{
+    const em::ivec2 a[] = {em::ivec2(1, 2), em::ivec2(-0x7fffffff - 1, 0)};
+    em::ivec2 out[2]{};
+    return em::Math::Robust::checked_batch<em::ivec2>::neg(a, out) && out[0] == em::ivec2(-1, -2);
+}());
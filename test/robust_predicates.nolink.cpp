@@ -0,0 +1,32 @@
+#include "em/math/robust_predicates.h"
+
+namespace Robust = em::Math::Robust;
+
+// Orientation.
+static_assert(Robust::orient2d(em::ivec2(0,0), em::ivec2(1,0), em::ivec2(0,1)) == 1);
+static_assert(Robust::orient2d(em::ivec2(0,0), em::ivec2(0,1), em::ivec2(1,0)) == -1);
+static_assert(Robust::orient2d(em::ivec2(0,0), em::ivec2(1,1), em::ivec2(2,2)) == 0);
+// Large integers, where the products are about `4e18`, above `2^53`, so they get rounded, and the naive formula gives 0 for all of these.
+static_assert(Robust::orient2d(em::ivec2(999999999,1000000000), em::ivec2(999999998,999999999), em::ivec2(-1000000000,-1000000000)) == 1);
+static_assert(Robust::orient2d(em::ivec2(999999998,999999999), em::ivec2(999999999,1000000000), em::ivec2(-1000000000,-1000000000)) == -1);
+static_assert(Robust::orient2d(em::ivec2(-1999999999,-1999999997), em::ivec2(1,3), em::ivec2(2000000001,2000000003)) == 0);
+// Nearly collinear, where the rounding errors of the naive formula are larger than the result.
+static_assert(Robust::orient2d(em::dvec2(0.5,0.5), em::dvec2(12,12), em::dvec2(24,24)) == 0);
+static_assert(Robust::orient2d(em::dvec2(0.5,0.5), em::dvec2(12,12), em::dvec2(24,24 + 0x1p-48)) == 1);
+static_assert(Robust::orient2d(em::fvec2(0.5f,0.5f), em::fvec2(12,12), em::fvec2(24,24 - 0x1p-19f)) == -1);
+
+static_assert(Robust::orient3d(em::ivec3(0,0,0), em::ivec3(1,0,0), em::ivec3(0,1,0), em::ivec3(0,0,-1)) == 1);
+static_assert(Robust::orient3d(em::ivec3(0,0,0), em::ivec3(1,0,0), em::ivec3(0,1,0), em::ivec3(0,0,1)) == -1);
+static_assert(Robust::orient3d(em::ivec3(0,0,0), em::ivec3(1,0,0), em::ivec3(0,1,0), em::ivec3(5,7,0)) == 0);
+static_assert(Robust::orient3d(em::dvec3(0,0,0), em::dvec3(1,0,0), em::dvec3(0,1,0), em::dvec3(0.3,0.7,-0x1p-60)) == 1);
+
+// Circles and spheres.
+static_assert(Robust::incircle(em::ivec2(0,0), em::ivec2(2,0), em::ivec2(0,2), em::ivec2(1,1)) == 1);
+static_assert(Robust::incircle(em::ivec2(0,0), em::ivec2(2,0), em::ivec2(0,2), em::ivec2(2,2)) == 0);
+static_assert(Robust::incircle(em::ivec2(0,0), em::ivec2(2,0), em::ivec2(0,2), em::ivec2(3,3)) == -1);
+static_assert(Robust::incircle(em::dvec2(0,0), em::dvec2(2,0), em::dvec2(0,2), em::dvec2(2,2 + 0x1p-50)) == -1);
+static_assert(Robust::incircle(em::dvec2(0,0), em::dvec2(2,0), em::dvec2(0,2), em::dvec2(2,2 - 0x1p-50)) == 1);
+
+static_assert(Robust::insphere(em::ivec3(0,0,0), em::ivec3(1,0,0), em::ivec3(0,1,0), em::ivec3(0,0,-1), em::ivec3(0,0,0)) == 0);
+static_assert(Robust::insphere(em::dvec3(0,0,0), em::dvec3(1,0,0), em::dvec3(0,1,0), em::dvec3(0,0,-1), em::dvec3(0.2,0.2,-0.2)) == 1);
+static_assert(Robust::insphere(em::dvec3(0,0,0), em::dvec3(1,0,0), em::dvec3(0,1,0), em::dvec3(0,0,-1), em::dvec3(1,1,-1 - 0x1p-50)) == -1);
@@ -0,0 +1,52 @@
+#include "em/math/running_stats.h"
+
+#include <array>
+#include <limits>
+
+static_assert(std::is_same_v<em::running_stats<float>::value_type, double>);
+static_assert(std::is_same_v<em::running_stats<em::fvec3>::value_type, em::dvec3>);
+static_assert(std::is_same_v<em::running_stats<em::fvec3, false, em::fvec3>::value_type, em::fvec3>);
+
+static_assert([]{
+    em::running_stats<int> s;
+    for (int x : {1, 2, 3, 4})
+        s.push(x);
+    return s.count() == 4 && s.mean() == 2.5 && s.variance() == 1.25 && s.min() == 1 && s.max() == 4;
+}());
+
+// Merging gives the same result as pushing everything into one accumulator.
+static_assert([]{
+    em::running_stats<double> a, b;
+    for (double x : {1, 2, 3})
+        a.push(x);
+    for (double x : {4, 5, 6, 7, 8})
+        b.push(x);
+    a.merge(b);
+    return a.count() == 8 && a.mean() == 4.5 && a.sample_variance() == 6 && a.min() == 1 && a.max() == 8;
+}());
+
+// Pushing a span, four full blocks and a partial one.
+// Every block has the same mean and the stats are small dyadic fractions, so the result is exact.
+static_assert([]{
+    std::array<int, em::running_stats<int>::block_size * 4 + 4> values{};
+    for (std::size_t i = 0; i < values.size(); i++)
+        values[i] = int(i % 4); // 0, 1, 2, 3, 0, 1, ...
+    em::running_stats<int> s;
+    s.push(values, 1);
+    return s.count() == values.size() && s.min() == 0 && s.max() == 3 && s.mean() == 1.5 && s.variance() == 1.25 &&
+        s.sample_variance() == 1.25 * double(values.size()) / double(values.size() - 1);
+}());
+
+// The min and the max start at the infinities for floats, so they're correct even if all samples are infinite.
+static_assert(em::running_stats<float>().min() == std::numeric_limits<float>::infinity() && em::running_stats<float>().max() == -std::numeric_limits<float>::infinity());
+static_assert(em::running_stats<int>().min() == std::numeric_limits<int>::max() && em::running_stats<int>().max() == std::numeric_limits<int>::lowest());
+
+// The covariance.
+static_assert([]{
+    em::running_stats<em::fvec2, true> s;
+    s.push(std::array{em::fvec2(1, -1), em::fvec2(3, -3)});
+    s.push(em::fvec2(2, -2));
+    return s.mean() == em::dvec2(2, -2) && s.variance() == em::dvec2(2 / 3., 2 / 3.) &&
+        s.sample_covariance() == em::running_stats<em::fvec2, true>::matrix_type(em::dvec2(1, -1), em::dvec2(-1, 1)) &&
+        s.min() == em::fvec2(1, -3) && s.max() == em::fvec2(3, -1);
+}());
@@ -0,0 +1,31 @@
+#include "em/math/skinning.h"
+
+#include <array>
+
+using skinning = em::linear_blend_skinning<float>;
+
+// Two bones: a translation by 10 along X, and a 90 degree rotation around Z. The vertex is attached to both equally.
+static_assert([]{
+    const std::array<skinning::bone_type, 2> bones = {
+        skinning::bone_type(em::fvec3(1,0,0), em::fvec3(0,1,0), em::fvec3(0,0,1), em::fvec3(10,0,0)),
+        skinning::bone_type(em::fvec3(0,1,0), em::fvec3(-1,0,0), em::fvec3(0,0,1), em::fvec3(0,0,0)),
+    };
+    const std::array<em::u8vec4, 1> indices = {em::u8vec4(0, 1, 0, 0)};
+    const std::array<em::fvec4, 1> weights = {em::fvec4(0.5f, 0.5f, 0, 0)};
+    const std::array<em::fvec3, 1> positions = {em::fvec3(2, 0, 1)};
+    const std::array<em::fvec3, 1> normals = {em::fvec3(1, 0, 0)};
+    std::array<em::fvec3, 1> out_positions{}, out_normals{};
+    skinning::apply(bones, indices, weights, positions, normals, out_positions, out_normals, 1);
+    return out_positions[0] == em::fvec3(6, 1, 1) && out_normals[0] == em::fvec3(0.5f, 0.5f, 0);
+}());
+
+// 16-bit indices, without normals.
+static_assert([]{
+    std::array<skinning::bone_type, 300> bones{};
+    bones[299] = skinning::bone_type(em::fvec3(2,0,0), em::fvec3(0,2,0), em::fvec3(0,0,2), em::fvec3(1,1,1));
+    const std::array<em::u16vec4, 1> indices = {em::u16vec4(299, 0, 0, 0)};
+    const std::array<em::fvec4, 1> weights = {em::fvec4(1, 0, 0, 0)};
+    std::array<em::fvec3, 1> positions = {em::fvec3(1, 2, 3)};
+    skinning::apply(bones, indices, weights, positions, {}, positions, {}, 1);
+    return positions[0] == em::fvec3(3, 5, 7);
+}());
@@ -0,0 +1,90 @@
+#include "em/math/space_filling_curves.h"
+
+#include <array>
+#include <limits>
+
+// Morton codes.
+static_assert(em::morton_encode(em::ivec2(3, 5)) == 39);
+static_assert(em::morton_encode(em::u16vec3(1, 2, 4)) == 273);
+static_assert(em::morton_encode(em::uvec2(0xffffffff, 0)) == 0x5555555555555555);
+static_assert(em::morton_encode(em::uvec3(0, 0, 0x1fffff)) == 0x4924924924924924);
+static_assert(em::morton_decode<em::ivec2>(39) == em::ivec2(3, 5));
+static_assert(em::morton_decode<em::u16vec3>(273) == em::u16vec3(1, 2, 4));
+static_assert(em::morton_decode<em::uvec2>(0xffffffffffffffff) == em::uvec2(0xffffffff));
+static_assert(em::morton_decode<em::ivec3>(0x7fffffffffffffff) == em::ivec3(0x1fffff));
+
+// Hilbert indices.
+static_assert(em::hilbert_encode(em::ivec2(3, 5)) == 52);
+static_assert(em::hilbert_encode(em::ivec3(3, 5, 7)) == 177);
+static_assert(em::hilbert_encode(em::uvec2(0xffffffff, 0)) == 0xffffffffffffffff); // The last point.
+static_assert(em::hilbert_encode(em::ivec3(0x1fffff, 0, 0)) == 0x7fffffffffffffff);
+static_assert(em::hilbert_decode<em::ivec2>(52) == em::ivec2(3, 5));
+static_assert(em::hilbert_decode<em::ivec3>(177) == em::ivec3(3, 5, 7));
+
+// The consecutive Hilbert indices are neighbors, and the first ones stay near the origin.
+template <typename V>
+constexpr bool CheckHilbertContinuity(int count, int cube_size)
+{
+    V prev{};
+    for (int i = 0; i < count; i++)
+    {
+        V cur = em::hilbert_decode<V>(std::uint64_t(i));
+        if (em::hilbert_encode(cur) != std::uint64_t(i))
+            return false;
+        int dist = 0;
+        for (int j = 0; j < em::vec_size<V>; j++)
+        {
+            if (cur[j] >= cube_size)
+                return false;
+            dist += cur[j] > prev[j] ? cur[j] - prev[j] : prev[j] - cur[j];
+        }
+        if (dist != (i > 0 ? 1 : 0))
+            return false;
+        prev = cur;
+    }
+    return true;
+}
+static_assert(CheckHilbertContinuity<em::ivec2>(256, 16));
+static_assert(CheckHilbertContinuity<em::ivec3>(512, 8));
+
+// Round trips.
+static_assert([]{
+    for (int x : {0, 1, 77, 0x1fffff})
+    for (int y : {0, 2, 1000, 0x1fffff})
+    for (int z : {0, 5, 0x1ffffe})
+    {
+        em::ivec3 v(x, y, z);
+        if (em::morton_decode<em::ivec3>(em::morton_encode(v)) != v || em::hilbert_decode<em::ivec3>(em::hilbert_encode(v)) != v)
+            return false;
+        em::ivec2 w(x * 1000, y * 999);
+        if (em::morton_decode<em::ivec2>(em::morton_encode(w)) != w || em::hilbert_decode<em::ivec2>(em::hilbert_encode(w)) != w)
+            return false;
+    }
+    return true;
+}());
+
+// Range checks.
+constexpr int int_min = std::numeric_limits<int>::min(), int_max = std::numeric_limits<int>::max();
+static_assert(em::space_filling_curve_in_range(em::ivec2(int_max, 0)));
+static_assert(!em::space_filling_curve_in_range(em::ivec2(int_min, 0)));
+static_assert(!em::space_filling_curve_in_range(em::ivec2(0, -1)));
+static_assert(em::space_filling_curve_in_range(em::uvec2(0xffffffff)));
+static_assert(!em::space_filling_curve_in_range(em::vec2<long long>(0x100000000, 0)));
+static_assert(em::space_filling_curve_in_range(em::ivec3(0x1fffff)));
+static_assert(!em::space_filling_curve_in_range(em::ivec3(0, 0x200000, 0)));
+static_assert(!em::space_filling_curve_in_range(em::ivec3(int_max, 0, 0)));
+static_assert(em::morton_encode_checked(em::ivec2(int_max, 0)) == 0x1555555555555555);
+static_assert(em::hilbert_encode_checked(em::ivec3(3, 5, 7)) == 177);
+
+// Spans.
+static_assert([]{
+    std::array<em::ivec2, 3> points = {em::ivec2(3, 5), em::ivec2(0, 0), em::ivec2(1, 1)};
+    std::array<std::uint64_t, 3> codes{};
+    em::morton_encode(std::span<const em::ivec2>(points), std::span(codes));
+    if (codes != std::array<std::uint64_t, 3>{39, 0, 3})
+        return false;
+    std::array<em::ivec2, 3> decoded{};
+    em::morton_decode<em::ivec2>(std::span<const std::uint64_t>(codes), std::span(decoded));
+    em::hilbert_encode(std::span<const em::ivec2>(points), std::span(codes));
+    return decoded == points && codes[0] == 52 && codes[2] == 2;
+}());
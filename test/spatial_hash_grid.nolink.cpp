@@ -0,0 +1,48 @@
+#include "em/math/spatial_hash_grid.h"
+
+#include <array>
+#include <cstdint>
+
+// Cells, also for negative coordinates.
+static_assert(em::spatial_hash_grid<float, 2>(2).cell_of(em::fvec2(3.9f, -0.1f)) == em::ivec2(1, -1));
+static_assert(em::spatial_hash_grid<float, 2>(2).cell_of(em::fvec2(-2, -2.1f)) == em::ivec2(-1, -2));
+static_assert(em::spatial_hash_grid<int, 3>(4).cell_of(em::ivec3(-1, -4, -5)) == em::ivec3(-1, -1, -2));
+static_assert(em::spatial_hash_grid<int, 3>(4).cell_of(em::ivec3(0, 3, 4)) == em::ivec3(0, 0, 1));
+
+// Cell and neighborhood queries.
+static_assert([]{
+    std::array<em::fvec2, 6> points = {
+        em::fvec2(0.5f, 0.5f),
+        em::fvec2(0.7f, 0.1f),
+        em::fvec2(-0.5f, 0.5f),
+        em::fvec2(1.5f, 1.5f),
+        em::fvec2(2.5f, 0.5f),
+        em::fvec2(-100, 100),
+    };
+    em::spatial_hash_grid<float, 2> grid(1);
+    grid.build(points);
+    if (grid.size() != 6)
+        return false;
+
+    auto Mask = [&](auto &&query)
+    {
+        std::uint32_t mask = 0;
+        query([&](std::uint32_t i){mask |= std::uint32_t(1) << i;});
+        return mask;
+    };
+    return
+        Mask([&](auto &&f){grid.for_each_in_cell(em::ivec2(0, 0), f);}) == 0b11 &&
+        Mask([&](auto &&f){grid.for_each_in_cell(em::ivec2(-100, 100), f);}) == 0b100000 &&
+        Mask([&](auto &&f){grid.for_each_in_cell(em::ivec2(5, 5), f);}) == 0 &&
+        Mask([&](auto &&f){grid.for_each_in_neighborhood(em::ivec2(0, 0), f);}) == 0b1111 &&
+        Mask([&](auto &&f){grid.for_each_near(em::fvec2(1.1f, 0.5f), f);}) == 0b11011;
+}());
+
+// Empty grids.
+static_assert([]{
+    em::spatial_hash_grid<int, 3> grid(16);
+    grid.build({});
+    int count = 0;
+    grid.for_each_in_neighborhood(em::ivec3(0), [&](std::uint32_t){count++;});
+    return grid.empty() && count == 0;
+}());
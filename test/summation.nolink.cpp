@@ -0,0 +1,49 @@
+#include "em/math/summation.h"
+
+#include <array>
+
+// The plain loop would lose the ones.
+static_assert(em::summation<float>::compensated(std::array{1e8f, 1.f, -1e8f, 1.f}) == 2);
+// Enough elements for two rounds of the lanes, plus a tail.
+static_assert([]{
+    std::array<float, 81> values{};
+    for (std::size_t i = 0; i < 80; i += 4)
+    {
+        values[i] = 1e8f;
+        values[i + 1] = 1;
+        values[i + 2] = -1e8f;
+        values[i + 3] = 1;
+    }
+    values[80] = 1;
+    return em::summation<float>::compensated(values, 1) == 41;
+}());
+
+// Vectors are summed elementwise.
+static_assert(em::summation<em::fvec2>::compensated(std::array{em::fvec2(1e8f, 1), em::fvec2(1, 2), em::fvec2(-1e8f, 3)}) == em::fvec2(1, 6));
+
+static_assert([]{
+    em::compensated_sum<double> a, b;
+    a += 1e20;
+    a += 1;
+    b += -1e20;
+    b += 1;
+    a += b;
+    return a.value() == 2;
+}());
+
+// The rounding error of the product is kept too: `(1 + 2^-12)^2 - (1 + 2^-11) == 2^-24`.
+static_assert(em::summation<float>::compensated_dot(std::array{1 + 0x1p-12f, -(1 + 0x1p-11f)}, std::array{1 + 0x1p-12f, 1.f}) == 0x1p-24f);
+static_assert([]{
+    em::compensated_sum<double> s;
+    s.add_product(1 + 0x1p-27, 1 + 0x1p-27);
+    s += -(1 + 0x1p-26);
+    return s.value() == 0x1p-54;
+}());
+
+static_assert([]{
+    std::array<double, 1000> values{};
+    values.fill(0.5);
+    return em::summation<double>::pairwise(values) == 500;
+}());
+static_assert(em::summation<double>::pairwise({}) == 0);
+static_assert(em::summation<double>::compensated({}) == 0);
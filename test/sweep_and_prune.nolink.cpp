@@ -0,0 +1,41 @@
+#include "em/math/sweep_and_prune.h"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+// Returns the pairs sorted, to compare them easily.
+constexpr std::vector<em::sweep_and_prune_pair> SortedPairs(em::sweep_and_prune<int> &sap)
+{
+    auto span = sap.find_pairs();
+    std::vector<em::sweep_and_prune_pair> ret(span.begin(), span.end());
+    std::sort(ret.begin(), ret.end(), [](const auto &x, const auto &y){return x.a != y.a ? x.a < y.a : x.b < y.b;});
+    return ret;
+}
+
+static_assert([]{
+    std::array<em::irect2, 5> rects = {
+        em::irect2(em::ivec2(0, 0), em::ivec2(4, 4)),
+        em::irect2(em::ivec2(10, 0), em::ivec2(12, 2)),
+        em::irect2(em::ivec2(3, 3), em::ivec2(5, 5)),
+        em::irect2(em::ivec2(4, 0), em::ivec2(6, 1)), // Touches 0, overlaps nothing.
+        em::irect2(em::ivec2(2, 10), em::ivec2(3, 20)), // Overlaps 0 along X only.
+    };
+
+    em::sweep_and_prune<int> sap;
+    sap.update(rects);
+    if (sap.size() != 5 || SortedPairs(sap) != std::vector<em::sweep_and_prune_pair>{{0, 2}})
+        return false;
+
+    // Move the rects, which changes their order along X.
+    rects[1] = rects[1] - em::ivec2(9, 0);
+    rects[3] = rects[3] - em::ivec2(0, 10);
+    rects[4] = rects[4] - em::ivec2(0, 8);
+    sap.update(rects);
+    if (SortedPairs(sap) != std::vector<em::sweep_and_prune_pair>{{0, 1}, {0, 2}, {0, 4}})
+        return false;
+
+    // Remove some rects.
+    sap.update(std::span(rects).first(2));
+    return SortedPairs(sap) == std::vector<em::sweep_and_prune_pair>{{0, 1}};
+}());
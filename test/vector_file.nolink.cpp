@@ -0,0 +1,34 @@
+#include "em/math/vector_file.h"
+
+#include <array>
+
+static_assert(em::vec_file_scalar<float> && em::vec_file_scalar<std::uint16_t>);
+static_assert(!em::vec_file_scalar<bool> && !em::vec_file_scalar<long double>);
+
+static_assert(em::vec_file<float, 3>::make_header(5).count == 5);
+static_assert(em::vec_file<float, 3>::make_header(5).dims == 3);
+static_assert(em::vec_file<float, 3>::make_header(5).elem_type == em::vec_file_elem_type::f32);
+static_assert(!em::vec_file<float, 3>::make_header(5).is_foreign());
+static_assert(std::is_same_v<em::vec_file<float, 1>::elem_type, float>);
+
+// Foreign headers.
+static_assert([]{
+    em::vec_file_header header = em::vec_file<std::int32_t, 2>::make_header(0x0102);
+    header.big_endian = !header.big_endian;
+    header.count = 0x0201000000000000;
+    return header.is_foreign() && header.native_count() == 0x0102;
+}());
+
+// Byte swapping.
+static_assert([]{
+    std::array<em::i32vec2, 2> values = {em::i32vec2(0x01020304, -1), em::i32vec2(0, 0x7f)};
+    em::vec_file<std::int32_t, 2>::byte_swap(values, values, 1);
+    return values[0] == em::i32vec2(0x04030201, -1) && values[1] == em::i32vec2(0, 0x7f000000);
+}());
+static_assert([]{
+    const std::array<double, 2> values = {1.5, -2.25};
+    std::array<double, 2> swapped{};
+    em::vec_file<double, 1>::byte_swap(values, swapped, 1);
+    em::vec_file<double, 1>::byte_swap(swapped, swapped, 1);
+    return swapped == values;
+}());
@@ -0,0 +1,13 @@
+#include "em/math/vector_functions.h"
+
+static_assert(em::dot(em::ivec3(1,2,3), em::ivec3(4,5,6)) == 32);
+static_assert(std::is_same_v<decltype(em::dot(em::ivec3(), em::fvec3())), float>);
+
+static_assert(em::cross(em::ivec2(1,0), em::ivec2(0,1)) == 1);
+static_assert(em::cross(em::ivec2(0,1), em::ivec2(1,0)) == -1);
+static_assert(em::cross(em::ivec3(1,0,0), em::ivec3(0,1,0)) == em::ivec3(0,0,1));
+static_assert(em::cross(em::ivec3(0,1,0), em::ivec3(0,0,1)) == em::ivec3(1,0,0));
+static_assert(std::is_same_v<decltype(em::cross(em::ivec3(), em::fvec3())), em::fvec3>);
+
+static_assert(em::length_sq(em::ivec2(3,4)) == 25);
+static_assert(em::distance_sq(em::ivec2(1,1), em::ivec2(4,5)) == 25);
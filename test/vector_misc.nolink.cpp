@@ -75,3 +75,22 @@ static_assert(wd3(1,2).value == em::ivec3(1,2,-3));
 static_assert(wd2(em::ivec2(1,2)).value == em::ivec2(1,2));
 static_assert(wd2(1,2).value == em::ivec2(1,2));
 static_assert(wd2(1).value == em::ivec2(1,-2));
+
+
+// `std::hash`:
+
+static_assert(std::is_default_constructible_v<std::hash<em::ivec2>>);
+static_assert(std::is_default_constructible_v<std::hash<em::vec2<em::ivec3>>>);
+static_assert(std::is_default_constructible_v<std::hash<em::i64vec4>>);
+namespace { struct NotHashable {}; }
+static_assert(!std::is_default_constructible_v<std::hash<em::vec2<NotHashable>>>); // No hash for the element type.
+
+static_assert(std::hash<em::ivec2>{}(em::ivec2(1, 2)) == std::hash<em::ivec2>{}(em::ivec2(1, 2)));
+static_assert(std::hash<em::ivec2>{}(em::ivec2(1, 2)) != std::hash<em::ivec2>{}(em::ivec2(2, 1)));
+static_assert(std::hash<em::ivec2>{}(em::ivec2(-1, 0)) != std::hash<em::ivec2>{}(em::ivec2(0, -1)));
+static_assert(std::hash<em::i64vec3>{}(em::i64vec3(1, 2, 3)) != std::hash<em::i64vec3>{}(em::i64vec3(3, 2, 1)));
+static_assert(std::hash<em::bvec4>{}(em::bvec4(true, false, false, false)) != std::hash<em::bvec4>{}(em::bvec4(false, true, false, false)));
+
+// Equal vectors must have equal hashes, even for `-0` and `+0`.
+static_assert(std::hash<em::fvec2>{}(em::fvec2(-0.f, 1)) == std::hash<em::fvec2>{}(em::fvec2(0.f, 1)));
+static_assert(std::hash<em::dvec3>{}(em::dvec3(-0., 1, -0.)) == std::hash<em::dvec3>{}(em::dvec3(0., 1, 0.)));
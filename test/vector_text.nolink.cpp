@@ -0,0 +1,71 @@
+#include "em/math/vector_text.h"
+
+#include <string_view>
+
+#ifdef __cpp_lib_format
+static_assert(std::formattable<em::fvec3, char>);
+static_assert(std::formattable<em::ivec2, wchar_t>);
+#endif
+
+static_assert(std::is_same_v<em::vec_text<em::fvec3>::elem_type, float>);
+static_assert(std::is_same_v<em::vec_text<int>::elem_type, int>);
+static_assert(em::vec_text<em::dvec4>::max_chars >= (24 + 2) * 4 + 2); // `-2.2250738585072014e-308` is the longest double.
+
+// Parses `text`, starting with `value` and returning it along with the error and the number of consumed characters.
+template <typename V>
+struct ParseResult
+{
+    V value{};
+    std::errc ec{};
+    std::size_t length = 0;
+
+    constexpr bool operator==(const ParseResult &) const = default;
+};
+template <typename V>
+[[nodiscard]] constexpr ParseResult<V> Parse(std::string_view text, V value = {}, const em::vec_text_style &style = {})
+{
+    std::from_chars_result result = em::vec_text<V>::from_chars(text.data(), text.data() + text.size(), value, style);
+    return {value, result.ec, std::size_t(result.ptr - text.data())};
+}
+
+// Bools don't use `std::{to,from}_chars()`, so they work in constant evaluation everywhere.
+static_assert(Parse<em::bvec3>("(1, 0, 1)") == ParseResult<em::bvec3>{em::bvec3(true, false, true), {}, 9});
+static_assert(Parse<em::bvec3>(" \t( 1 ,0 , 1 ) x") == ParseResult<em::bvec3>{em::bvec3(true, false, true), {}, 14});
+static_assert(Parse<em::bvec3>("1,0,1") == ParseResult<em::bvec3>{em::bvec3(true, false, true), {}, 5});
+static_assert(Parse<em::bvec3>("1 0 1 0") == ParseResult<em::bvec3>{em::bvec3(true, false, true), {}, 5}); // Stops right after the last element.
+static_assert(Parse<em::bvec3>("[1;0;1]", {}, {.open = '[', .close = ']', .separator = ';'}) == ParseResult<em::bvec3>{em::bvec3(true, false, true), {}, 7});
+static_assert(Parse<bool>(" 1") == ParseResult<bool>{true, {}, 2});
+// On failure, the value isn't modified and the pointer is at the beginning.
+static_assert(Parse<em::bvec3>("(1, 0, 1", em::bvec3(false, true, true)) == ParseResult<em::bvec3>{em::bvec3(false, true, true), std::errc::invalid_argument, 0});
+static_assert(Parse<em::bvec3>("1, 2, 1") == ParseResult<em::bvec3>{{}, std::errc::invalid_argument, 0});
+static_assert(Parse<em::bvec3>("1 0") == ParseResult<em::bvec3>{{}, std::errc::invalid_argument, 0});
+static_assert(Parse<em::bvec3>("[1;0;1]").ec == std::errc::invalid_argument);
+
+static_assert(em::vec_text<em::bvec3>::to_string(em::bvec3(true, false, true)) == "(1, 0, 1)");
+static_assert(em::vec_text<em::bvec3>::to_string(em::bvec3(true, false, true), {.open = 0, .close = 0, .separator = 0}) == "1 0 1");
+static_assert(em::vec_text<em::bvec3>::to_string(em::bvec3(true, false, true), {.separator = ';', .space_after_separator = false}) == "(1;0;1)");
+static_assert(em::vec_text<bool>::to_string(true) == "1"); // No brackets around scalars.
+static_assert([]{
+    char buffer[8];
+    std::to_chars_result result = em::vec_text<em::bvec3>::to_chars(buffer, buffer + 8, em::bvec3(true, false, true));
+    return result.ec == std::errc::value_too_large && result.ptr == buffer + 8;
+}());
+
+static_assert([]{
+    em::bvec2 values[3];
+    std::size_t offset = 0;
+    std::size_t count = em::vec_text<em::bvec2>::parse_batch("1 0\n(0, 1)\n ", values, {}, &offset);
+    return count == 2 && offset == 12 && values[0] == em::bvec2(true, false) && values[1] == em::bvec2(false, true);
+}());
+
+#if __cpp_lib_constexpr_charconv >= 202207L
+static_assert(Parse<em::ivec2>("(-12, 34)") == ParseResult<em::ivec2>{em::ivec2(-12, 34), {}, 9});
+static_assert(Parse<em::ivec2>("(99999999999, 1)") == ParseResult<em::ivec2>{{}, std::errc::result_out_of_range, 0});
+static_assert(Parse<em::ivec2>("(+1, 2)").ec == std::errc::invalid_argument); // Like `std::from_chars()`, there's no plus sign.
+static_assert(em::vec_text<em::ivec3>::to_string(em::ivec3(-1, 0, 2147483647)) == "(-1, 0, 2147483647)");
+static_assert(em::vec_text<int>::to_string(-42) == "-42");
+static_assert(Parse<em::i64vec2>(em::vec_text<em::i64vec2>::to_string(em::i64vec2(-9223372036854775807 - 1, 1))).value == em::i64vec2(-9223372036854775807 - 1, 1));
+#endif
+
+// Floats and the `std::formatter` aren't tested here: the tests are only compiled, and `std::{to,from}_chars()` for floats and `std::format()`
+//   can't run in constant evaluation.